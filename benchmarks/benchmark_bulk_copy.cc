@@ -0,0 +1,80 @@
+// queue imports
+#include "SPSCLocal.hh"
+#include "bulk_copy.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/// Trivially copyable record of `Width` bytes
+template<std::size_t Width>
+struct Payload {
+    std::int64_t words[Width / sizeof(std::int64_t)];
+};
+
+enum class Kernel { StdCopy, Vector, Streaming };
+
+/// Raw kernels: range(0) bytes from one buffer to another, GB/s counted on bytes written
+template<Kernel K>
+static void BM_kernel(benchmark::State& state) {
+    const auto bytes = static_cast<std::size_t>(state.range(0));
+    std::vector<std::byte> src(bytes, std::byte{1});
+    std::vector<std::byte> dst(bytes);
+    for (auto _ : state) {
+        if constexpr (K == Kernel::StdCopy) {
+            std::copy(src.begin(), src.end(), dst.begin());
+        } else {
+            bulkCopyBytes(dst.data(), src.data(), bytes, K == Kernel::Streaming);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(std::int64_t(state.iterations()) * std::int64_t(bytes));
+}
+
+/// Ring level: push then pop range(0) records of `Width` bytes through an SPSCLocal whose
+/// ring exceeds the cache, per element (`std::copy`-style loop) or with pushBulk/popBulk
+template<std::size_t Width, bool Bulk>
+static void BM_ring(benchmark::State& state) {
+    using Record = Payload<Width>;
+    const auto batch = static_cast<std::size_t>(state.range(0));
+    constexpr int ringSize = (64 << 20) / Width;
+    auto fifo = std::make_unique<SPSCLocal<Record, ringSize>>();
+    std::vector<Record> in(batch), out(batch);
+    for (auto i = std::size_t{}; i < batch; ++i) {
+        in[i].words[0] = static_cast<std::int64_t>(i);
+    }
+
+    for (auto _ : state) {
+        if constexpr (Bulk) {
+            fifo->pushBulk(in.data(), batch);
+            fifo->popBulk(out.data(), batch);
+        } else {
+            for (const auto& record : in) {
+                fifo->push(record);
+            }
+            for (auto& record : out) {
+                fifo->pop(record);
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    // Every record is copied in and out
+    state.SetBytesProcessed(std::int64_t(state.iterations()) * std::int64_t(2 * batch * Width));
+}
+
+BENCHMARK_TEMPLATE(BM_kernel, Kernel::StdCopy) -> RangeMultiplier(8) -> Range(4 << 10, 64 << 20);
+BENCHMARK_TEMPLATE(BM_kernel, Kernel::Vector) -> RangeMultiplier(8) -> Range(4 << 10, 64 << 20);
+BENCHMARK_TEMPLATE(BM_kernel, Kernel::Streaming) -> RangeMultiplier(8) -> Range(4 << 10, 64 << 20);
+
+// range(0): records per batch
+BENCHMARK_TEMPLATE(BM_ring, 16, false) -> RangeMultiplier(8) -> Range(8, 1 << 15);
+BENCHMARK_TEMPLATE(BM_ring, 16, true) -> RangeMultiplier(8) -> Range(8, 1 << 15);
+BENCHMARK_TEMPLATE(BM_ring, 64, false) -> RangeMultiplier(8) -> Range(8, 1 << 15);
+BENCHMARK_TEMPLATE(BM_ring, 64, true) -> RangeMultiplier(8) -> Range(8, 1 << 15);
+BENCHMARK_TEMPLATE(BM_ring, 256, false) -> RangeMultiplier(8) -> Range(8, 1 << 15);
+BENCHMARK_TEMPLATE(BM_ring, 256, true) -> RangeMultiplier(8) -> Range(8, 1 << 15);
+
+BENCHMARK_MAIN();
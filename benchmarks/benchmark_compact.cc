@@ -0,0 +1,118 @@
+// queue imports
+#include "SPSCCompact.hh"
+#include "SPSCLocal.hh"
+#include "fifo4.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using tt = std::int64_t;
+
+static constexpr std::size_t queues = 10'000;
+/// Per-session queues are short
+static constexpr int fifoSize = 64;
+static constexpr std::int64_t rounds = 200;
+
+/// Bytes one queue requests from the allocator and the number of allocations it makes.
+/// (RSS deltas are useless here: earlier benchmarks in the process leave freed pages behind.)
+template<typename Q>
+struct Footprint {
+    static constexpr std::size_t bytes = sizeof(Q) + fifoSize * sizeof(typename Q::value_type);
+    static constexpr std::size_t allocations = 2;
+};
+
+template<typename T, int N>
+struct Footprint<SPSCCompact<T, N>> {
+    static constexpr std::size_t bytes = SPSCCompact<T, N>::allocationSize();
+    static constexpr std::size_t allocations = 1;
+};
+
+/// Owning handles for every layout, created the way a session table would
+template<typename Q>
+struct QueueSet {
+    std::vector<std::unique_ptr<Q>> fifos;
+
+    QueueSet() {
+        fifos.reserve(queues);
+        for (auto i = std::size_t{}; i < queues; ++i) {
+            if constexpr (std::is_default_constructible_v<Q>) {
+                fifos.push_back(std::make_unique<Q>());
+            } else {
+                fifos.push_back(std::make_unique<Q>(fifoSize));
+            }
+        }
+    }
+
+    Q& operator[](std::size_t i) { return *fifos[i]; }
+};
+
+template<typename T, int N>
+struct QueueSet<SPSCCompact<T, N>> {
+    std::vector<typename SPSCCompact<T, N>::Ptr> fifos;
+
+    QueueSet() {
+        fifos.reserve(queues);
+        for (auto i = std::size_t{}; i < queues; ++i) {
+            fifos.push_back(SPSCCompact<T, N>::create());
+        }
+    }
+
+    SPSCCompact<T, N>& operator[](std::size_t i) { return *fifos[i]; }
+};
+
+/// One producer sweeping all queues pushing one element each, one consumer sweeping behind
+/// it; every access lands on a different queue, so the header and ring footprint decides
+/// how much of the working set stays cached
+template<typename Q>
+static void BM_many_queues(benchmark::State& state) {
+    QueueSet<Q> set;
+    // Touch every header and the first ring line
+    tt value;
+    for (auto i = std::size_t{}; i < queues; ++i) {
+        set[i].push(0);
+        set[i].pop(value);
+    }
+
+    std::int64_t moved = 0;
+    for (auto _ : state) {
+        std::thread consumer{[&] {
+            pinThread(1);
+            tt v;
+            for (auto r = std::int64_t{}; r < rounds; ++r) {
+                for (auto i = std::size_t{}; i < queues; ++i) {
+                    while (not set[i].pop(v)) {
+                        ;
+                    }
+                    benchmark::DoNotOptimize(v);
+                }
+            }
+        }};
+        pinThread(0);
+        for (auto r = std::int64_t{}; r < rounds; ++r) {
+            for (auto i = std::size_t{}; i < queues; ++i) {
+                while (not set[i].push(r)) {
+                    ;
+                }
+            }
+        }
+        consumer.join();
+        moved += rounds * static_cast<std::int64_t>(queues);
+    }
+
+    state.counters["ops/sec"] = benchmark::Counter(double(moved), benchmark::Counter::kIsRate);
+    state.counters["bytes_per_queue"] = double(Footprint<Q>::bytes);
+    state.counters["header_bytes"] = double(sizeof(Q));
+    state.counters["allocations_per_queue"] = double(Footprint<Q>::allocations);
+}
+
+BENCHMARK_TEMPLATE(BM_many_queues, SPSCLocal<tt, fifoSize>) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_many_queues, Fifo4a<tt>) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_many_queues, SPSCCompact<tt, fifoSize>) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+
+BENCHMARK_MAIN();
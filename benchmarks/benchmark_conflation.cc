@@ -0,0 +1,158 @@
+// queue imports
+#include "ConflatingQueue.hh"
+#include "SPSCLocal.hh"
+#include "latency_stats.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+static constexpr std::size_t instruments = 1024;
+static constexpr std::int64_t ticks = 1 << 20;
+/// Idle time between bursts
+static constexpr std::int64_t gapNs = 50'000;
+/// Consumer cost per update, e.g. repricing a book
+static constexpr std::int64_t workNs = 200;
+
+struct Tick {
+    std::int64_t key;
+    std::int64_t price;
+    std::int64_t sentNs;
+};
+
+/// Zipf(s = 1.1) distributed instrument ids: a few hot instruments take most of the ticks
+static const std::vector<std::uint32_t>& zipfKeys() {
+    static const auto keys = [] {
+        std::vector<double> cdf(instruments);
+        auto sum = 0.0;
+        for (auto k = std::size_t{}; k < instruments; ++k) {
+            sum += 1.0 / std::pow(double(k + 1), 1.1);
+            cdf[k] = sum;
+        }
+        std::mt19937_64 rng{42};
+        std::uniform_real_distribution<double> uniform{0.0, sum};
+        std::vector<std::uint32_t> keys(ticks);
+        for (auto& key : keys) {
+            auto it = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng));
+            key = static_cast<std::uint32_t>(std::min<std::ptrdiff_t>(it - cdf.begin(), instruments - 1));
+        }
+        return keys;
+    }();
+    return keys;
+}
+
+static void spinFor(std::int64_t ns) {
+    auto until = nowNs() + ns;
+    while (nowNs() < until) {
+        ;
+    }
+}
+
+/// Producer sends bursts of range(0) ticks separated by gapNs, blocking only if the queue is full
+template<typename PushFn>
+static void produce(std::int64_t burst, PushFn push) {
+    const auto& keys = zipfKeys();
+    for (auto i = std::int64_t{}; i < ticks; ++i) {
+        push(Tick{keys[i], i, nowNs()});
+        if ((i + 1) % burst == 0) {
+            spinFor(gapNs);
+        }
+    }
+}
+
+static void report(benchmark::State& state, std::int64_t processed, LatencySamples& staleness) {
+    state.counters["updates/sec"] = benchmark::Counter(double(processed), benchmark::Counter::kIsRate);
+    state.counters["processed_pct"] = 100.0 * double(processed) / double(ticks * state.iterations());
+    state.counters["stale_p50_ns"] = staleness.percentile(50);
+    state.counters["stale_p99_ns"] = staleness.percentile(99);
+    state.counters["stale_max_ns"] = staleness.max();
+}
+
+static void BM_plain(benchmark::State& state) {
+    const auto burst = state.range(0);
+    LatencySamples staleness{ticks};
+    std::int64_t processed = 0;
+    zipfKeys();
+
+    for (auto _ : state) {
+        SPSCLocal<Tick, 1 << 17> queue;
+        std::atomic<bool> done{false};
+        std::thread producer{[&] {
+            pinThread(1);
+            produce(burst, [&](const Tick& tick) {
+                while (not queue.push(tick)) {
+                    ;
+                }
+            });
+            done.store(true, std::memory_order_release);
+        }};
+
+        pinThread(0);
+        Tick tick;
+        while (true) {
+            auto finished = done.load(std::memory_order_acquire);
+            while (queue.pop(tick)) {
+                spinFor(workNs);
+                staleness.record(nowNs() - tick.sentNs);
+                ++processed;
+            }
+            if (finished) {
+                break;
+            }
+        }
+        producer.join();
+    }
+    report(state, processed, staleness);
+}
+
+static void BM_conflating(benchmark::State& state) {
+    const auto burst = state.range(0);
+    LatencySamples staleness{ticks};
+    std::int64_t processed = 0;
+    std::uint64_t conflated = 0;
+    zipfKeys();
+
+    for (auto _ : state) {
+        ConflatingQueue<Tick, instruments> queue{instruments};
+        std::atomic<bool> done{false};
+        std::thread producer{[&] {
+            pinThread(1);
+            produce(burst, [&](const Tick& tick) {
+                queue.push(static_cast<std::uint32_t>(tick.key), tick);
+            });
+            done.store(true, std::memory_order_release);
+        }};
+
+        pinThread(0);
+        while (true) {
+            auto finished = done.load(std::memory_order_acquire);
+            while (queue.drain([&](std::uint32_t, const Tick& tick) {
+                spinFor(workNs);
+                staleness.record(nowNs() - tick.sentNs);
+                ++processed;
+            })) {
+                ;
+            }
+            if (finished) {
+                break;
+            }
+        }
+        producer.join();
+        conflated += queue.conflated();
+    }
+    report(state, processed, staleness);
+    state.counters["conflated_pct"] = 100.0 * double(conflated) / double(ticks * state.iterations());
+}
+
+// range(0): ticks per burst
+BENCHMARK(BM_plain) -> Arg(64) -> Arg(1024) -> Arg(8192) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK(BM_conflating) -> Arg(64) -> Arg(1024) -> Arg(8192) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+
+BENCHMARK_MAIN();
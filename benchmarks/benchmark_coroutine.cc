@@ -0,0 +1,139 @@
+// queue imports
+#include "AsyncSPSC.hh"
+#include "SPSCLocal.hh"
+#include "executor.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <ctime>
+#include <stdexcept>
+#include <thread>
+
+static constexpr int fifoSize = 131072; // 2048 * 8 * 8
+static constexpr long items = 1'000'000l;
+
+using tt = std::int64_t;
+
+/// CPU time consumed by the calling thread, in seconds
+static double threadCpuSeconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/// Busy waits for `gap` to emulate a producer running below full load
+static void pace(std::chrono::nanoseconds gap) {
+    if (gap.count() == 0) {
+        return;
+    }
+    auto until = std::chrono::steady_clock::now() + gap;
+    while (std::chrono::steady_clock::now() < until) {
+        ;
+    }
+}
+
+static void reportCounters(benchmark::State& state, double consumerCpu, double wall) {
+    state.counters["ops/sec"] = benchmark::Counter(double(items) * state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["consumer_cpu"] = consumerCpu / wall;
+}
+
+/// Busy-spin producer and consumer, as BM_queue, with the producer paced by range(0) ns
+template<typename T>
+static void BM_spin(benchmark::State& state) {
+    auto gap = std::chrono::nanoseconds{state.range(0)};
+    double consumerCpu = 0;
+    double wall = 0;
+
+    for (auto _ : state) {
+        T fifo;
+        auto start = std::chrono::steady_clock::now();
+
+        auto th = std::thread([&] {
+            pinThread(1);
+            auto cpuStart = threadCpuSeconds();
+            for (auto i = tt{}; i < items; ++i) {
+                tt val;
+                while (not fifo.pop(val)) {
+                    ;
+                }
+                benchmark::DoNotOptimize(val);
+                if (val != i) {
+                    throw std::runtime_error("invalid value");
+                }
+            }
+            consumerCpu += threadCpuSeconds() - cpuStart;
+        });
+
+        pinThread(2);
+        for (auto i = tt{}; i < items; ++i) {
+            while (auto again = not fifo.push(i)) {
+                benchmark::DoNotOptimize(again);
+            }
+            pace(gap);
+        }
+        th.join();
+        wall += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    reportCounters(state, consumerCpu, wall);
+}
+
+template<typename T>
+static DetachedTask produce(T& fifo, SingleThreadExecutor& executor, std::chrono::nanoseconds gap) {
+    co_await executor.schedule();
+    for (auto i = tt{}; i < items; ++i) {
+        co_await fifo.async_push(i, &executor);
+        pace(gap);
+    }
+    executor.stop();
+}
+
+template<typename T>
+static DetachedTask consume(T& fifo, SingleThreadExecutor& executor) {
+    co_await executor.schedule();
+    for (auto i = tt{}; i < items; ++i) {
+        auto val = co_await fifo.async_pop(&executor);
+        benchmark::DoNotOptimize(val);
+        if (val != i) {
+            throw std::runtime_error("invalid value");
+        }
+    }
+    executor.stop();
+}
+
+/// Coroutine producer and consumer, each resumed by its own executor thread
+template<typename T>
+static void BM_coroutine(benchmark::State& state) {
+    auto gap = std::chrono::nanoseconds{state.range(0)};
+    double consumerCpu = 0;
+    double wall = 0;
+
+    for (auto _ : state) {
+        T fifo;
+        SingleThreadExecutor producer;
+        SingleThreadExecutor consumer;
+        auto start = std::chrono::steady_clock::now();
+
+        auto th = std::thread([&] {
+            pinThread(1);
+            auto cpuStart = threadCpuSeconds();
+            consume(fifo, consumer);
+            consumer.run();
+            consumerCpu += threadCpuSeconds() - cpuStart;
+        });
+
+        pinThread(2);
+        produce(fifo, producer, gap);
+        producer.run();
+        th.join();
+        wall += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    reportCounters(state, consumerCpu, wall);
+}
+
+// range(0): producer gap in ns; 0 is full load
+BENCHMARK_TEMPLATE(BM_spin, SPSCLocal<tt, fifoSize>) -> Arg(0) -> Arg(100) -> Arg(1000) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_coroutine, AsyncSPSC<tt, fifoSize>) -> Arg(0) -> Arg(100) -> Arg(1000) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+
+BENCHMARK_MAIN();
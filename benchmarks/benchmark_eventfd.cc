@@ -0,0 +1,146 @@
+// queue imports
+#include "NotifyingSPSC.hh"
+#include "SPSCLocal.hh"
+#include "latency_stats.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <sys/epoll.h>
+
+static constexpr int fifoSize = 131072; // 2048 * 8 * 8
+static constexpr long items = 200'000l;
+
+struct Message {
+    std::int64_t seq;
+    std::int64_t sentNs;
+};
+
+/// Owning epoll instance with the queue's eventfd registered
+class EventLoop
+{
+public:
+    explicit EventLoop(int fd)
+        : epfd_{::epoll_create1(EPOLL_CLOEXEC)}
+    {
+        if (epfd_ == -1) {
+            throw std::system_error(errno, std::system_category(), "epoll_create1");
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            throw std::system_error(errno, std::system_category(), "epoll_ctl");
+        }
+    }
+
+    ~EventLoop() { ::close(epfd_); }
+
+    void wait() {
+        epoll_event events[4];
+        while (::epoll_wait(epfd_, events, 4, -1) == -1 and errno == EINTR) {
+            ;
+        }
+    }
+
+private:
+    int epfd_;
+};
+
+/// Producer sends bursts of range(0) messages separated by range(1) us of idle time.
+/// The consumer drains, arms the sleeping flag and waits in epoll once the queue is empty.
+template<typename T>
+static void BM_eventfd(benchmark::State& state) {
+    const long burst = state.range(0);
+    const auto idle = std::chrono::microseconds{state.range(1)};
+
+    std::uint64_t syscalls = 0;
+    std::uint64_t delivered = 0;
+    LatencySamples wakeups{items};
+
+    for (auto _ : state) {
+        T fifo;
+        EventLoop loop{fifo.fd()};
+        std::uint64_t consumerSyscalls = 0;
+
+        auto th = std::thread([&] {
+            pinThread(1);
+            bool woken = false;
+            for (auto i = std::int64_t{}; i < items;) {
+                Message msg;
+                while (fifo.pop(msg)) {
+                    if (msg.seq != i) {
+                        throw std::runtime_error("invalid value");
+                    }
+                    if (woken) {
+                        wakeups.record(nowNs() - msg.sentNs);
+                        woken = false;
+                    }
+                    ++i;
+                }
+                if (i == items or not fifo.prepareToSleep()) {
+                    continue;
+                }
+                loop.wait();
+                fifo.acknowledge();
+                consumerSyscalls += 2;
+                woken = true;
+            }
+        });
+
+        pinThread(2);
+        for (auto i = std::int64_t{}; i < items;) {
+            for (auto end = std::min(i + burst, items); i < end; ++i) {
+                while (auto again = not fifo.push(Message{i, nowNs()})) {
+                    benchmark::DoNotOptimize(again);
+                }
+            }
+            std::this_thread::sleep_for(idle);
+        }
+        th.join();
+
+        syscalls += consumerSyscalls + fifo.signals();
+        delivered += items;
+    }
+
+    state.counters["ops/sec"] = benchmark::Counter(double(delivered), benchmark::Counter::kIsRate);
+    state.counters["msgs/syscall"] = syscalls ? double(delivered) / syscalls : double(delivered);
+    state.counters["wakeup_p50_ns"] = wakeups.percentile(50);
+    state.counters["wakeup_p99_ns"] = wakeups.percentile(99);
+    state.counters["wakeup_max_ns"] = wakeups.max();
+}
+
+/// Push and pop batches of 32 on one thread with the consumer never asleep: the cost the
+/// sleeping-flag check adds to every push, against a plain SPSCLocal
+template<typename Fifo>
+static void BM_hotPath(benchmark::State& state) {
+    auto fifo = std::make_unique<Fifo>();
+    Message message{};
+    for (auto _ : state) {
+        for (auto i = 0; i < 32; ++i) {
+            message.seq = i;
+            fifo->push(message);
+        }
+        for (auto i = 0; i < 32; ++i) {
+            fifo->pop(message);
+        }
+        benchmark::DoNotOptimize(message);
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(state.iterations() * 64), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_TEMPLATE(BM_hotPath, SPSCLocal<Message, 1024>);
+BENCHMARK_TEMPLATE(BM_hotPath, NotifyingSPSC<Message, 1024>);
+
+// range(0): burst size; range(1): idle time between bursts in microseconds
+BENCHMARK_TEMPLATE(BM_eventfd, NotifyingSPSC<Message, fifoSize>)
+    -> Args({1, 10}) -> Args({64, 10}) -> Args({1024, 10}) -> Args({1024, 100})
+    -> Unit(benchmark::kMillisecond) -> UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,140 @@
+// queue imports
+#include "BoundedMPMC.hh"
+#include "FanIn.hh"
+#include "SPSCLocal.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+static constexpr std::int64_t items = 1 << 21;
+
+/// Producer index in the high bits, per-producer sequence in the low bits
+static constexpr int seqBits = 40;
+
+static std::int64_t encode(std::int64_t producer, std::int64_t seq) { return (producer << seqBits) | seq; }
+static std::int64_t producerOf(std::int64_t value) { return value >> seqBits; }
+static std::int64_t seqOf(std::int64_t value) { return value & ((std::int64_t{1} << seqBits) - 1); }
+
+using PerProducerQueue = SPSCLocal<std::int64_t, 1 << 12>;
+using SharedQueue = BoundedMPMC<std::int64_t, 1 << 17>;
+
+/// Producers spread over cpus 1.., wrapping around; the consumer stays on cpu 0
+static int producerCpu(std::int64_t producer) {
+    const auto ncpus = std::max(1u, std::thread::hardware_concurrency());
+    return ncpus == 1 ? 0 : static_cast<int>(1 + producer % (ncpus - 1));
+}
+
+/// Consumer side bookkeeping shared by both designs: per-producer FIFO order is checked
+struct OrderCheck {
+    std::vector<std::int64_t> next;
+    std::int64_t violations{0};
+
+    explicit OrderCheck(std::int64_t producers) : next(producers, 0) {}
+
+    void operator()(std::int64_t value) {
+        auto& expected = next[producerOf(value)];
+        violations += seqOf(value) != expected;
+        expected = seqOf(value) + 1;
+    }
+};
+
+static void report(benchmark::State& state, std::int64_t delivered, std::int64_t violations) {
+    state.counters["ops/sec"] = benchmark::Counter(double(delivered), benchmark::Counter::kIsRate);
+    state.counters["order_violations"] = double(violations);
+}
+
+/// One SPSC queue per producer, drained through the fan-in selector
+template<FanInMode Mode>
+static void BM_fanin(benchmark::State& state) {
+    const auto producers = state.range(0);
+    const auto perProducer = items / producers;
+    std::int64_t delivered = 0;
+    std::int64_t violations = 0;
+
+    for (auto _ : state) {
+        FanIn<PerProducerQueue> fanIn{static_cast<std::size_t>(producers), Mode};
+        std::vector<std::thread> threads;
+        for (auto p = std::int64_t{}; p < producers; ++p) {
+            threads.emplace_back([&fanIn, p, perProducer] {
+                pinThread(producerCpu(p));
+                for (auto i = std::int64_t{}; i < perProducer; ++i) {
+                    while (not fanIn.push(p, encode(p, i))) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        pinThread(0);
+        OrderCheck check{producers};
+        auto received = std::int64_t{};
+        while (received < perProducer * producers) {
+            auto n = fanIn.poll([&check](std::size_t, std::int64_t value) { check(value); });
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            received += n;
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        delivered += received;
+        violations += check.violations;
+    }
+    report(state, delivered, violations);
+}
+
+/// All producers share one bounded ring
+static void BM_shared_ring(benchmark::State& state) {
+    const auto producers = state.range(0);
+    const auto perProducer = items / producers;
+    std::int64_t delivered = 0;
+    std::int64_t violations = 0;
+
+    for (auto _ : state) {
+        SharedQueue queue;
+        std::vector<std::thread> threads;
+        for (auto p = std::int64_t{}; p < producers; ++p) {
+            threads.emplace_back([&queue, p, perProducer] {
+                pinThread(producerCpu(p));
+                for (auto i = std::int64_t{}; i < perProducer; ++i) {
+                    while (not queue.push(encode(p, i))) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        pinThread(0);
+        OrderCheck check{producers};
+        auto received = std::int64_t{};
+        std::int64_t value;
+        while (received < perProducer * producers) {
+            if (queue.pop(value)) {
+                check(value);
+                ++received;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        delivered += received;
+        violations += check.violations;
+    }
+    report(state, delivered, violations);
+}
+
+// range(0): number of producer threads
+BENCHMARK_TEMPLATE(BM_fanin, FanInMode::RoundRobin) -> RangeMultiplier(2) -> Range(4, 64) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_fanin, FanInMode::WeightedPriority) -> RangeMultiplier(2) -> Range(4, 64) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_fanin, FanInMode::DrainBatch) -> RangeMultiplier(2) -> Range(4, 64) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK(BM_shared_ring) -> RangeMultiplier(2) -> Range(4, 64) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,71 @@
+// queue imports
+#include "SPSCLocal.hh"
+#include "index_policy.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+
+using tt = std::int64_t;
+
+/// The capacity we actually need, and the power of two it used to be rounded up to
+static constexpr std::size_t wanted = 100'000;
+static constexpr std::size_t rounded = 1 << 17;
+
+/// `cursor % capacity_` with the capacity in a member, as BasicSPSC does it: a real division
+template<std::size_t N>
+struct RuntimeModuloIndex {
+    static constexpr std::size_t capacity = N;
+
+    std::size_t operator()(std::size_t cursor) const noexcept { return cursor % divisor_; }
+
+    std::size_t divisor_ = N;
+};
+
+/// Cursor to slot mapping alone, over sequential cursors as a queue side would issue them
+template<typename Index>
+static void BM_map(benchmark::State& state) {
+    Index index;
+    benchmark::DoNotOptimize(index);
+    std::size_t cursor = 0;
+    for (auto _ : state) {
+        for (auto i = 0; i < 1024; ++i) {
+            benchmark::DoNotOptimize(index(cursor++));
+        }
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(state.iterations() * 1024), benchmark::Counter::kIsRate);
+}
+
+/// Push and pop batches through an SPSCLocal using the policy
+template<typename Index>
+static void BM_ring(benchmark::State& state) {
+    using Fifo = SPSCLocal<tt, int(Index::capacity), std::allocator<tt>, Index>;
+    auto fifo = std::make_unique<Fifo>();
+    tt value = 0;
+    for (auto _ : state) {
+        for (auto i = 0; i < 64; ++i) {
+            fifo->push(i);
+        }
+        for (auto i = 0; i < 64; ++i) {
+            fifo->pop(value);
+        }
+        benchmark::DoNotOptimize(value);
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(state.iterations() * 128), benchmark::Counter::kIsRate);
+    state.counters["ring_bytes"] = double(Index::capacity * sizeof(tt));
+}
+
+BENCHMARK_TEMPLATE(BM_map, MaskIndex<rounded>);
+BENCHMARK_TEMPLATE(BM_map, ModuloIndex<wanted>);
+BENCHMARK_TEMPLATE(BM_map, RuntimeModuloIndex<wanted>);
+BENCHMARK_TEMPLATE(BM_map, FastModIndex<wanted>);
+BENCHMARK_TEMPLATE(BM_map, WrapIndex<wanted>);
+
+BENCHMARK_TEMPLATE(BM_ring, MaskIndex<rounded>);
+BENCHMARK_TEMPLATE(BM_ring, ModuloIndex<wanted>);
+BENCHMARK_TEMPLATE(BM_ring, RuntimeModuloIndex<wanted>);
+BENCHMARK_TEMPLATE(BM_ring, FastModIndex<wanted>);
+BENCHMARK_TEMPLATE(BM_ring, WrapIndex<wanted>);
+
+BENCHMARK_MAIN();
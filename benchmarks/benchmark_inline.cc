@@ -0,0 +1,60 @@
+// queue imports
+#include "SPSCInline.hh"
+#include "SPSCLocal.hh"
+#include "custom_benchmark.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+using tt = std::int64_t;
+
+static constexpr std::int64_t iterations = 10'000'000;
+
+/// Push and pop batches of 32 on one thread: address computation and slot access alone,
+/// without cache line transfers between cores
+template<typename Fifo>
+static void BM_batch(benchmark::State& state) {
+    auto fifo = std::make_unique<Fifo>();
+    tt value = 0;
+    for (auto _ : state) {
+        for (auto i = 0; i < 32; ++i) {
+            fifo->push(i);
+        }
+        for (auto i = 0; i < 32; ++i) {
+            fifo->pop(value);
+        }
+        benchmark::DoNotOptimize(value);
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(state.iterations() * 64), benchmark::Counter::kIsRate);
+}
+
+/// Producer/consumer throughput with the two threads on cpus 1 and 2
+template<typename Fifo>
+static void BM_transfer(benchmark::State& state) {
+    const auto ncpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    BenchOptions options;
+    options.producerCpu = 1 % ncpus;
+    options.consumerCpu = 2 % ncpus;
+    for (auto _ : state) {
+        auto opsPerSec = Bench<Fifo>{options}(iterations);
+        state.SetIterationTime(double(iterations) / opsPerSec);
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(iterations * state.iterations()), benchmark::Counter::kIsRate);
+}
+
+#define INLINE_BENCHMARK(capacity)                                                               \
+    BENCHMARK_TEMPLATE(BM_batch, SPSCLocal<tt, capacity>);                                       \
+    BENCHMARK_TEMPLATE(BM_batch, SPSCInline<tt, capacity>);                                      \
+    BENCHMARK_TEMPLATE(BM_transfer, SPSCLocal<tt, capacity>) -> UseManualTime() -> Unit(benchmark::kMillisecond); \
+    BENCHMARK_TEMPLATE(BM_transfer, SPSCInline<tt, capacity>) -> UseManualTime() -> Unit(benchmark::kMillisecond)
+
+INLINE_BENCHMARK(64);
+INLINE_BENCHMARK(256);
+INLINE_BENCHMARK(1024);
+INLINE_BENCHMARK(4096);
+
+BENCHMARK_MAIN();
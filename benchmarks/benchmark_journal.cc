@@ -0,0 +1,161 @@
+// queue imports
+#include "Journal.hh"
+#include "latency_stats.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+static constexpr std::int64_t records = 1 << 20;
+static constexpr std::int64_t batch = 64;
+
+/// 64 byte record with a send timestamp
+struct Record {
+    std::int64_t seq;
+    std::int64_t sentNs;
+    std::int64_t payload[6];
+};
+
+/// Fresh journal directory under $JOURNAL_BENCH_DIR (default: the system temp directory),
+/// removed again on destruction. Point it at the filesystem you want to measure.
+class ScratchDirectory
+{
+public:
+    explicit ScratchDirectory(const std::string& name) {
+        const char* base = std::getenv("JOURNAL_BENCH_DIR");
+        path_ = std::filesystem::path{base ? base : std::filesystem::temp_directory_path().string()} / name;
+        std::filesystem::remove_all(path_);
+    }
+
+    ~ScratchDirectory() { std::filesystem::remove_all(path_); }
+
+    const std::filesystem::path& path() const noexcept { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+static JournalConfig configFor(SyncPolicy sync) {
+    JournalConfig config;
+    config.sync = sync;
+    config.syncInterval = std::chrono::milliseconds{1};
+    return config;
+}
+
+/// Append throughput in batches of `batch` records under each msync policy
+template<SyncPolicy Sync>
+static void BM_append(benchmark::State& state) {
+    std::int64_t appended = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        ScratchDirectory directory{"journal_append"};
+        {
+            Journal journal{directory.path(), configFor(Sync)};
+            state.ResumeTiming();
+
+            Record record{};
+            for (auto i = std::int64_t{}; i < records; ++i) {
+                record.seq = i;
+                journal.append(record);
+                if ((i + 1) % batch == 0) {
+                    journal.endBatch();
+                }
+            }
+            state.PauseTiming();
+        }
+        appended += records;
+        state.ResumeTiming();
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(appended), benchmark::Counter::kIsRate);
+    state.counters["bytes/sec"] = benchmark::Counter(double(appended * sizeof(Record)), benchmark::Counter::kIsRate,
+                                                     benchmark::Counter::kIs1024);
+}
+
+/// Latency from append to the tailer reading the record in place, at a paced rate of one
+/// record per microsecond
+template<SyncPolicy Sync>
+static void BM_tail_latency(benchmark::State& state) {
+    constexpr std::int64_t paced = records / 16;
+    LatencySamples latency{paced};
+    for (auto _ : state) {
+        ScratchDirectory directory{"journal_tail"};
+        Journal journal{directory.path(), configFor(Sync)};
+        std::atomic<bool> done{false};
+
+        std::thread tailer{[&] {
+            pinThread(1);
+            JournalTailer reader{directory.path()};
+            auto seen = std::int64_t{};
+            while (seen < paced) {
+                seen += reader.read([&](const std::byte* data, std::uint32_t) {
+                    Record record;
+                    std::memcpy(&record, data, sizeof(record));
+                    latency.record(nowNs() - record.sentNs);
+                });
+            }
+            done.store(true, std::memory_order_release);
+        }};
+
+        pinThread(0);
+        Record record{};
+        for (auto i = std::int64_t{}; i < paced; ++i) {
+            record.seq = i;
+            record.sentNs = nowNs();
+            journal.append(record);
+            if ((i + 1) % batch == 0) {
+                journal.endBatch();
+            }
+            while (nowNs() - record.sentNs < 1000) {
+                ;
+            }
+        }
+        tailer.join();
+    }
+    state.counters["tail_p50_ns"] = latency.percentile(50);
+    state.counters["tail_p99_ns"] = latency.percentile(99);
+    state.counters["tail_max_ns"] = latency.max();
+}
+
+/// Replay speed of a fresh tailer over a journal written beforehand
+static void BM_replay(benchmark::State& state) {
+    ScratchDirectory directory{"journal_replay"};
+    {
+        Journal journal{directory.path()};
+        Record record{};
+        for (auto i = std::int64_t{}; i < records; ++i) {
+            record.seq = i;
+            journal.append(record);
+        }
+    }
+
+    std::int64_t replayed = 0;
+    for (auto _ : state) {
+        JournalTailer reader{directory.path()};
+        std::int64_t sum = 0;
+        replayed += static_cast<std::int64_t>(reader.replay([&sum](const std::byte* data, std::uint32_t) {
+            std::int64_t seq;
+            std::memcpy(&seq, data, sizeof(seq));
+            sum += seq;
+        }));
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(replayed), benchmark::Counter::kIsRate);
+    state.counters["bytes/sec"] = benchmark::Counter(double(replayed * sizeof(Record)), benchmark::Counter::kIsRate,
+                                                     benchmark::Counter::kIs1024);
+}
+
+BENCHMARK_TEMPLATE(BM_append, SyncPolicy::None) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_append, SyncPolicy::Periodic) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_append, SyncPolicy::PerBatch) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_tail_latency, SyncPolicy::None) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_tail_latency, SyncPolicy::Periodic) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_tail_latency, SyncPolicy::PerBatch) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK(BM_replay) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,77 @@
+// queue imports
+#include "SPSCLocal.hh"
+#include "cache_line.hh"
+#include "custom_benchmark.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using tt = std::int64_t;
+
+static constexpr int fifoSize = 1 << 14;
+static constexpr std::int64_t iterations = 10'000'000;
+
+template<std::size_t Separation, CursorGrouping Grouping>
+using Fifo = SPSCLocal<tt, fifoSize, std::allocator<tt>, MaskIndex<fifoSize>, CursorLayout<Separation, Grouping>>;
+
+/// Producer/consumer throughput for one placement of the four cursor fields; the producer
+/// and the consumer run on the cpus given by range(0) and range(1)
+template<std::size_t Separation, CursorGrouping Grouping>
+static void BM_layout(benchmark::State& state) {
+    const auto ncpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    BenchOptions options;
+    options.producerCpu = static_cast<int>(state.range(0)) % ncpus;
+    options.consumerCpu = static_cast<int>(state.range(1)) % ncpus;
+    for (auto _ : state) {
+        auto opsPerSec = Bench<Fifo<Separation, Grouping>>{options}(iterations);
+        state.SetIterationTime(double(iterations) / opsPerSec);
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(iterations * state.iterations()), benchmark::Counter::kIsRate);
+    state.counters["sizeof"] = double(sizeof(Fifo<Separation, Grouping>));
+}
+
+/// What the machine and the build think the line size is, printed with the results
+static void addCacheLineContext() {
+    std::string sysfs = "n/a";
+    std::ifstream coherency{"/sys/devices/system/cpu/cpu0/cache/index0/coherency_line_size"};
+    std::getline(coherency, sysfs);
+    benchmark::AddCustomContext("cacheLineSize (build)", std::to_string(cacheLineSize));
+    benchmark::AddCustomContext("coherency_line_size (sysfs)", sysfs);
+#ifdef __cpp_lib_hardware_interference_size
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+    benchmark::AddCustomContext("hardware_destructive_interference_size",
+                                std::to_string(std::hardware_destructive_interference_size));
+#pragma GCC diagnostic pop
+#endif
+}
+
+#define LAYOUT_BENCHMARK(separation, grouping)                                                  \
+    BENCHMARK_TEMPLATE(BM_layout, separation, CursorGrouping::grouping)                         \
+        -> ArgNames({"producer_cpu", "consumer_cpu"}) -> Args({1, 2}) -> UseManualTime()         \
+        -> Unit(benchmark::kMillisecond)
+
+// 0 packs all four fields into one line; 32 puts two fields on each 64-byte line; 128 and
+// 256 also step over adjacent-line prefetch pairs
+LAYOUT_BENCHMARK(0, Separate);
+LAYOUT_BENCHMARK(32, Separate);
+LAYOUT_BENCHMARK(64, Separate);
+LAYOUT_BENCHMARK(128, Separate);
+LAYOUT_BENCHMARK(256, Separate);
+LAYOUT_BENCHMARK(32, ByWriter);
+LAYOUT_BENCHMARK(64, ByWriter);
+LAYOUT_BENCHMARK(128, ByWriter);
+LAYOUT_BENCHMARK(256, ByWriter);
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    addCacheLineContext();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,114 @@
+// queue imports
+#include "AsyncLogger.hh"
+#include "latency_stats.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/// Log file under $LOG_BENCH_DIR (default: the system temp directory), removed on destruction
+class ScratchFile
+{
+public:
+    explicit ScratchFile(const std::string& name) {
+        const char* base = std::getenv("LOG_BENCH_DIR");
+        path_ = std::filesystem::path{base ? base : std::filesystem::temp_directory_path().string()} / name;
+        std::filesystem::remove(path_);
+    }
+
+    ~ScratchFile() { std::filesystem::remove(path_); }
+
+    const std::filesystem::path& path() const noexcept { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+static constexpr LogSite<std::int64_t, double, std::int32_t> fill{"order {} filled at {} qty {}"};
+
+static constexpr std::int64_t calls = 100'000;
+
+/// Cost on the calling thread only: range(0) = 1 logs through AsyncLogger, 0 formats and
+/// write()s inline like the code it replaces. Both include one clock read per call.
+static void BM_caller(benchmark::State& state) {
+    const bool async = state.range(0) == 1;
+    ScratchFile file{"benchmark_logger_caller.log"};
+    LatencySamples latency{static_cast<std::size_t>(calls)};
+    for (auto _ : state) {
+        latency.clear();
+        if (async) {
+            AsyncLogger<> logger{file.path(), LogOverflow::Block};
+            for (auto i = std::int64_t{}; i < calls; ++i) {
+                auto start = nowNs();
+                logger.log(fill, i, 101.25, 7);
+                latency.record(nowNs() - start);
+            }
+        } else {
+            int fd = ::open(file.path().c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            std::string line;
+            for (auto i = std::int64_t{}; i < calls; ++i) {
+                auto start = nowNs();
+                line.clear();
+                appendLogArgument(line, nowNs());
+                line += ' ';
+                std::int64_t id = i;
+                double price = 101.25;
+                std::int32_t qty = 7;
+                std::byte arguments[sizeof(id) + sizeof(price) + sizeof(qty)];
+                std::memcpy(arguments, &id, sizeof(id));
+                std::memcpy(arguments + sizeof(id), &price, sizeof(price));
+                std::memcpy(arguments + sizeof(id) + sizeof(price), &qty, sizeof(qty));
+                fill.render(line, fill.format, arguments);
+                line += '\n';
+                benchmark::DoNotOptimize(::write(fd, line.data(), line.size()));
+                latency.record(nowNs() - start);
+            }
+            ::close(fd);
+        }
+    }
+    state.counters["p50_ns"] = latency.percentile(50);
+    state.counters["p99_ns"] = latency.percentile(99);
+    state.counters["p999_ns"] = latency.percentile(99.9);
+    state.counters["max_ns"] = latency.max();
+}
+
+/// Sustained backend rate: range(0) threads log as fast as the Block policy lets them and
+/// the clock stops once flush() returns, so this is lines formatted and written per second
+static void BM_backend(benchmark::State& state) {
+    const auto threads = static_cast<int>(state.range(0));
+    ScratchFile file{"benchmark_logger_backend.log"};
+    std::uint64_t lines = 0;
+    for (auto _ : state) {
+        AsyncLogger<> logger{file.path(), LogOverflow::Block};
+        auto start = nowNs();
+        std::vector<std::thread> producers;
+        for (auto t = 0; t < threads; ++t) {
+            producers.emplace_back([&] {
+                for (auto i = std::int64_t{}; i < calls; ++i) {
+                    logger.log(fill, i, 101.25, 7);
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        logger.flush();
+        state.SetIterationTime(double(nowNs() - start) / 1e9);
+        lines += logger.written();
+    }
+    state.counters["lines/sec"] = benchmark::Counter(double(lines), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_caller) -> ArgName("async") -> Arg(0) -> Arg(1) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK(BM_backend) -> ArgName("threads") -> Arg(1) -> Arg(2) -> Arg(4) -> UseManualTime() -> Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,111 @@
+// queue imports
+#include "MirroredAllocator.hh"
+#include "SPSCLocal.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+static constexpr int ringBytes = 1 << 20;
+
+using SplitRing = SPSCLocal<std::byte, ringBytes>;
+using MirroredRing = SPSCLocal<std::byte, ringBytes, MirroredAllocator<std::byte>>;
+
+/// Copies `size` bytes in through as many prepare()/commit() rounds as the ring needs;
+/// one round whenever the window does not cross the wrap
+template<typename Ring>
+static void writeBytes(Ring& ring, const std::byte* data, std::size_t size) {
+    while (size > 0) {
+        auto span = ring.prepare(size);
+        std::memcpy(span.data(), data, span.size());
+        ring.commit(span.size());
+        data += span.size();
+        size -= span.size();
+    }
+}
+
+/// Calls `f` on `size` contiguous readable bytes and consumes them: in place when they do
+/// not cross the wrap, otherwise reassembled in `scratch`
+template<typename Ring, typename F>
+static void readBytes(Ring& ring, std::size_t size, std::vector<std::byte>& scratch, F&& f) {
+    auto span = ring.peek(size);
+    if (span.size() == size) {
+        f(span.data());
+        ring.consume(size);
+        return;
+    }
+    for (std::size_t copied = 0; copied < size;) {
+        auto part = ring.peek(size - copied);
+        std::memcpy(scratch.data() + copied, part.data(), part.size());
+        ring.consume(part.size());
+        copied += part.size();
+    }
+    f(scratch.data());
+}
+
+/// Length-prefixed records of range(0) payload bytes written and parsed in place in
+/// batches of 64; records of uneven size make every batch land somewhere else in the ring
+template<typename Ring>
+static void BM_records(benchmark::State& state) {
+    const auto payload = static_cast<std::uint32_t>(state.range(0));
+    auto ring = std::make_unique<Ring>();
+    std::vector<std::byte> record(sizeof(std::uint32_t) + payload);
+    std::memcpy(record.data(), &payload, sizeof(payload));
+    std::iota(reinterpret_cast<unsigned char*>(record.data()) + sizeof(payload),
+              reinterpret_cast<unsigned char*>(record.data()) + record.size(), 0);
+    std::vector<std::byte> scratch(record.size());
+
+    std::uint64_t checksum = 0;
+    for (auto _ : state) {
+        for (auto i = 0; i < 64; ++i) {
+            writeBytes(*ring, record.data(), record.size());
+        }
+        for (auto i = 0; i < 64; ++i) {
+            std::uint32_t size = 0;
+            readBytes(*ring, sizeof(size), scratch, [&](const std::byte* header) {
+                std::memcpy(&size, header, sizeof(size));
+            });
+            readBytes(*ring, size, scratch, [&](const std::byte* body) {
+                checksum += std::to_integer<std::uint64_t>(body[0]) + std::to_integer<std::uint64_t>(body[size - 1]);
+            });
+        }
+    }
+    benchmark::DoNotOptimize(checksum);
+    state.SetBytesProcessed(std::int64_t(state.iterations()) * 64 * std::int64_t(record.size()));
+}
+
+/// Batches of range(0) bytes with pushBulk/popBulk: one copy per side of the wrap on the
+/// plain ring, always one on the mirrored ring
+template<typename Ring>
+static void BM_bulk(benchmark::State& state) {
+    const auto batch = static_cast<std::size_t>(state.range(0));
+    auto ring = std::make_unique<Ring>();
+    std::vector<std::byte> in(batch, std::byte{1});
+    std::vector<std::byte> out(batch);
+    // Offset the cursors so batches do not line up with the ring end
+    ring->push(std::byte{0});
+    std::byte dummy;
+    ring->pop(dummy);
+
+    for (auto _ : state) {
+        ring->pushBulk(in.data(), batch);
+        ring->popBulk(out.data(), batch);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(std::int64_t(state.iterations()) * std::int64_t(2 * batch));
+}
+
+// range(0): payload bytes per record
+BENCHMARK_TEMPLATE(BM_records, SplitRing) -> RangeMultiplier(4) -> Range(13, 3331);
+BENCHMARK_TEMPLATE(BM_records, MirroredRing) -> RangeMultiplier(4) -> Range(13, 3331);
+
+// range(0): bytes per batch
+BENCHMARK_TEMPLATE(BM_bulk, SplitRing) -> RangeMultiplier(8) -> Range(67, 1 << 16);
+BENCHMARK_TEMPLATE(BM_bulk, MirroredRing) -> RangeMultiplier(8) -> Range(67, 1 << 16);
+
+BENCHMARK_MAIN();
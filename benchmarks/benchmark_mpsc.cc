@@ -0,0 +1,110 @@
+// queue imports
+#include "BoundedMPMC.hh"
+#include "IntrusiveMPSC.hh"
+#include "MutexQueue.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/// What an actor posts: 32 bytes that the ring and the mutex queue copy
+struct Payload {
+    std::uint64_t producer;
+    std::uint64_t sequence;
+    std::uint64_t data[2];
+};
+
+/// The same event living in a pool, passed by link
+struct PooledEvent : MPSCHook {
+    Payload payload;
+};
+
+static constexpr std::uint64_t events = 1'000'000;
+static constexpr int ringSize = 1 << 12;
+
+/// Mailboxes behind one interface: post() from any producer, take() on the consumer
+struct IntrusiveMailbox {
+    IntrusiveMPSC<PooledEvent> queue;
+
+    void post(PooledEvent& event) { queue.push(&event); }
+    bool take(Payload& payload) {
+        auto* event = queue.pop();
+        if (event) {
+            payload = event->payload;
+        }
+        return event;
+    }
+};
+
+/// Bounded shared ring: the payload is copied in and producers spin while it is full
+struct RingMailbox {
+    BoundedMPMC<Payload, ringSize> queue;
+
+    void post(PooledEvent& event) {
+        while (not queue.push(event.payload)) {
+            std::this_thread::yield();
+        }
+    }
+    bool take(Payload& payload) { return queue.pop(payload); }
+};
+
+/// std::deque behind a mutex, unbounded for practical purposes
+struct MutexMailbox {
+    MutexQueue<Payload> queue{events};
+
+    void post(PooledEvent& event) { queue.push(event.payload); }
+    bool take(Payload& payload) { return queue.pop(payload); }
+};
+
+/// range(0) producers post `events` pooled events between them into one mailbox drained
+/// by one consumer, which checks per-producer order
+template<typename Mailbox>
+static void BM_mpsc(benchmark::State& state) {
+    const auto producers = static_cast<std::uint64_t>(state.range(0));
+    const auto perProducer = events / producers;
+    std::vector<PooledEvent> pool(perProducer * producers);
+    for (auto i = std::uint64_t{}; i < pool.size(); ++i) {
+        pool[i].payload = Payload{i / perProducer, i % perProducer, {i, i}};
+    }
+    std::uint64_t outOfOrder = 0;
+
+    for (auto _ : state) {
+        auto mailbox = std::make_unique<Mailbox>();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (auto p = std::uint64_t{}; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (auto i = p * perProducer; i < (p + 1) * perProducer; ++i) {
+                    mailbox->post(pool[i]);
+                }
+            });
+        }
+        std::vector<std::uint64_t> next(producers);
+        Payload payload;
+        for (auto received = std::uint64_t{}; received < pool.size();) {
+            if (mailbox->take(payload)) {
+                outOfOrder += payload.sequence != next[payload.producer]++;
+                ++received;
+            }
+        }
+        state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    state.counters["events/sec"] = benchmark::Counter(double(pool.size() * state.iterations()), benchmark::Counter::kIsRate);
+    state.counters["out_of_order"] = double(outOfOrder);
+}
+
+BENCHMARK_TEMPLATE(BM_mpsc, IntrusiveMailbox) -> ArgName("producers") -> RangeMultiplier(2) -> Range(1, 16)
+    -> UseManualTime() -> Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_mpsc, RingMailbox) -> ArgName("producers") -> RangeMultiplier(2) -> Range(1, 16)
+    -> UseManualTime() -> Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_mpsc, MutexMailbox) -> ArgName("producers") -> RangeMultiplier(2) -> Range(1, 16)
+    -> UseManualTime() -> Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,114 @@
+// queue imports
+#include "PartitionedDispatcher.hh"
+#include "SPSCLocal.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+/// A normalized update: which instrument, and its sequence number within that instrument
+struct Message {
+    std::uint32_t instrument;
+    std::uint32_t sequence;
+};
+
+struct ByInstrument {
+    std::size_t operator()(const Message& message) const noexcept { return message.instrument; }
+};
+
+using Fifo = SPSCLocal<Message, 1 << 12>;
+using Dispatcher = PartitionedDispatcher<Fifo, ByInstrument>;
+
+static constexpr std::uint32_t instruments = 1024;
+static constexpr std::int64_t messages = 2'000'000;
+
+/// Zipf(1) instrument stream: the busiest instrument gets ~13% of the updates, so some
+/// partitions run much hotter than others
+static const std::vector<std::uint32_t>& skewedInstruments() {
+    static const auto stream = [] {
+        std::vector<double> weights(instruments);
+        for (auto i = 0u; i < instruments; ++i) {
+            weights[i] = 1.0 / (i + 1);
+        }
+        std::mt19937 rng{42};
+        std::discrete_distribution<std::uint32_t> pick{weights.begin(), weights.end()};
+        std::vector<std::uint32_t> stream(1 << 16);
+        std::generate(stream.begin(), stream.end(), [&] { return pick(rng); });
+        return stream;
+    }();
+    return stream;
+}
+
+/// One producer dispatching the skewed stream to range(0) consumer threads, staged in
+/// batches of range(1) (1 is the push-per-message baseline). Consumers check that every
+/// instrument's sequence numbers arrive in order.
+static void BM_dispatch(benchmark::State& state) {
+    const auto partitions = static_cast<std::size_t>(state.range(0));
+    const auto batch = static_cast<std::size_t>(state.range(1));
+    const auto& stream = skewedInstruments();
+    std::uint64_t outOfOrder = 0;
+    double hottestShare = 0;
+
+    for (auto _ : state) {
+        Dispatcher dispatcher{partitions, {}, PartitionFull::Block, batch};
+        std::atomic<bool> done{false};
+        std::atomic<std::uint64_t> violations{0};
+        std::vector<std::uint64_t> received(partitions);
+
+        std::vector<std::thread> consumers;
+        for (auto p = std::size_t{}; p < partitions; ++p) {
+            consumers.emplace_back([&, p] {
+                std::vector<std::int64_t> last(instruments, -1);
+                std::uint64_t count = 0;
+                std::uint64_t bad = 0;
+                auto& queue = dispatcher.queue(p);
+                Message message;
+                while (true) {
+                    if (queue.pop(message)) {
+                        bad += std::int64_t{message.sequence} <= last[message.instrument];
+                        last[message.instrument] = message.sequence;
+                        ++count;
+                    } else if (done.load(std::memory_order_acquire)) {
+                        if (queue.empty()) {
+                            break;
+                        }
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+                received[p] = count;
+                violations.fetch_add(bad, std::memory_order_relaxed);
+            });
+        }
+
+        std::vector<std::uint32_t> sequence(instruments);
+        auto start = std::chrono::steady_clock::now();
+        for (auto i = std::int64_t{}; i < messages; ++i) {
+            auto instrument = stream[static_cast<std::size_t>(i) & (stream.size() - 1)];
+            dispatcher.dispatch(Message{instrument, sequence[instrument]++});
+        }
+        dispatcher.flush();
+        done.store(true, std::memory_order_release);
+        for (auto& consumer : consumers) {
+            consumer.join();
+        }
+        state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        outOfOrder += violations.load(std::memory_order_relaxed);
+        hottestShare = double(*std::max_element(received.begin(), received.end())) / double(messages);
+    }
+    state.counters["msgs/sec"] = benchmark::Counter(double(messages * state.iterations()), benchmark::Counter::kIsRate);
+    state.counters["hottest_share"] = hottestShare;
+    state.counters["out_of_order"] = double(outOfOrder);
+}
+
+BENCHMARK(BM_dispatch) -> ArgNames({"partitions", "batch"})
+    -> ArgsProduct({{2, 4, 8, 16}, {1, 32}}) -> UseManualTime() -> Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
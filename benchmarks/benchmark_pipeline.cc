@@ -0,0 +1,101 @@
+// queue imports
+#include "Pipeline.hh"
+#include "SPSCLocal.hh"
+#include "SPSCWithoutFS.hh"
+#include "latency_stats.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+
+static constexpr long items = 1'000'000l;
+
+struct Message {
+    std::int64_t seq;
+    std::int64_t sentNs;
+};
+
+template<typename T>
+using LocalQueue = SPSCLocal<T, 4096>;
+
+template<typename T>
+using WithoutFSQueue = SPSCWithoutFS<T, 4096>;
+
+/// Intermediate stage forwarding the message unchanged
+struct Forward {
+    Message operator()(Message msg) const noexcept { return msg; }
+};
+
+/// Last stage; records end-to-end latency and publishes progress to the feeding thread
+struct Sink {
+    LatencySamples* latency;
+    std::atomic<std::int64_t>* received;
+
+    void operator()(Message msg) const {
+        latency->record(nowNs() - msg.sentNs);
+        received->store(msg.seq + 1, std::memory_order_release);
+    }
+};
+
+template<template<typename> class Queue, std::size_t... I>
+static auto makeChain(PipelineConfig config, Sink sink, std::index_sequence<I...>) {
+    return makePipeline<Message, Queue>(std::move(config), ((void)I, Forward{})..., sink);
+}
+
+/// Stage k is pinned to cpu k + 1; the feeding thread runs on cpu 0
+static PipelineConfig pinnedConfig(std::size_t stages) {
+    const auto ncpus = std::max(1u, std::thread::hardware_concurrency());
+    PipelineConfig config;
+    for (auto k = std::size_t{}; k < stages; ++k) {
+        config.cpus.push_back(static_cast<int>((k + 1) % ncpus));
+    }
+    return config;
+}
+
+/// `Stages` stage pipeline (Stages - 1 forwarding stages and a sink).
+/// range(0) == 0 streams at full speed for throughput; otherwise a single message is in
+/// flight at a time, which measures the unloaded per-hop latency.
+template<template<typename> class Queue, std::size_t Stages>
+static void BM_pipeline(benchmark::State& state) {
+    const bool pingPong = state.range(0) != 0;
+    LatencySamples latency{items};
+    std::int64_t delivered = 0;
+
+    for (auto _ : state) {
+        std::atomic<std::int64_t> received{0};
+        auto pipeline = makeChain<Queue>(pinnedConfig(Stages), Sink{&latency, &received},
+                                         std::make_index_sequence<Stages - 1>{});
+        pipeline.start();
+        pinThread(0);
+
+        for (auto i = std::int64_t{}; i < items; ++i) {
+            while (auto again = not pipeline.push(Message{i, nowNs()})) {
+                benchmark::DoNotOptimize(again);
+            }
+            while (pingPong and received.load(std::memory_order_acquire) <= i) {
+                ;
+            }
+        }
+        pipeline.stop();
+        delivered += items;
+    }
+
+    state.counters["ops/sec"] = benchmark::Counter(double(delivered), benchmark::Counter::kIsRate);
+    state.counters["e2e_p50_ns"] = latency.percentile(50);
+    state.counters["e2e_p99_ns"] = latency.percentile(99);
+    state.counters["hop_p50_ns"] = double(latency.percentile(50)) / Stages;
+    state.counters["hop_p99_ns"] = double(latency.percentile(99)) / Stages;
+}
+
+// range(0): 0 for streaming throughput, 1 for one message in flight
+BENCHMARK_TEMPLATE(BM_pipeline, LocalQueue, 2) -> Arg(0) -> Arg(1) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_pipeline, LocalQueue, 4) -> Arg(0) -> Arg(1) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_pipeline, LocalQueue, 8) -> Arg(0) -> Arg(1) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_pipeline, WithoutFSQueue, 2) -> Arg(0) -> Arg(1) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_pipeline, WithoutFSQueue, 4) -> Arg(0) -> Arg(1) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_pipeline, WithoutFSQueue, 8) -> Arg(0) -> Arg(1) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,100 @@
+// queue imports
+// Built twice: benchmark_probes with the USDT probes compiled in (when <sys/sdt.h> exists)
+// and benchmark_probes_off without them. Run both and compare; the fast-path rows must match.
+#ifdef QUEUE_PROBES_OFF
+#undef QUEUE_PROBES
+#endif
+
+#include "SPSCCompact.hh"
+#include "SPSCInline.hh"
+#include "SPSCLocal.hh"
+#include "latency_stats.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+using tt = std::int64_t;
+
+static constexpr std::int64_t iterations = 10'000'000;
+
+template<typename Fifo>
+static auto makeFifo() {
+    if constexpr (requires { Fifo::create(); }) {
+        return Fifo::create();
+    } else {
+        return std::make_unique<Fifo>();
+    }
+}
+
+/// Push and pop batches of 32 on one thread through a larger ring: every push and all but
+/// one pop per batch take the fast path, so probes compiled in must not change this row
+template<typename Fifo>
+static void BM_fastPath(benchmark::State& state) {
+    auto fifo = makeFifo<Fifo>();
+    tt value = 0;
+    for (auto _ : state) {
+        for (auto i = 0; i < 32; ++i) {
+            fifo->push(i);
+        }
+        for (auto i = 0; i < 32; ++i) {
+            fifo->pop(value);
+        }
+        benchmark::DoNotOptimize(value);
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(state.iterations() * 64), benchmark::Counter::kIsRate);
+}
+
+/// Producer/consumer transfer on cpus 1 and 2: with a small ring most operations reload
+/// the other side's cursor, run full or run empty, which is where the probe sites are
+template<typename Fifo>
+static void BM_transfer(benchmark::State& state) {
+    const auto ncpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    auto fifo = makeFifo<Fifo>();
+    for (auto _ : state) {
+        auto start = nowNs();
+        std::thread consumer{[&] {
+            pinThread(2 % ncpus);
+            tt value = 0;
+            for (auto i = std::int64_t{}; i < iterations; ++i) {
+                while (not fifo->pop(value)) {
+                }
+            }
+            benchmark::DoNotOptimize(value);
+        }};
+        std::thread producer{[&] {
+            pinThread(1 % ncpus);
+            for (auto i = std::int64_t{}; i < iterations; ++i) {
+                while (not fifo->push(i)) {
+                }
+            }
+        }};
+        producer.join();
+        consumer.join();
+        state.SetIterationTime(double(nowNs() - start) / 1e9);
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(iterations * state.iterations()), benchmark::Counter::kIsRate);
+}
+
+#define PROBES_BENCHMARK(capacity)                                                               \
+    BENCHMARK_TEMPLATE(BM_transfer, SPSCLocal<tt, capacity>) -> UseManualTime() -> Unit(benchmark::kMillisecond); \
+    BENCHMARK_TEMPLATE(BM_transfer, SPSCCompact<tt, capacity>) -> UseManualTime() -> Unit(benchmark::kMillisecond); \
+    BENCHMARK_TEMPLATE(BM_transfer, SPSCInline<tt, capacity>) -> UseManualTime() -> Unit(benchmark::kMillisecond)
+
+BENCHMARK_TEMPLATE(BM_fastPath, SPSCLocal<tt, 1024>);
+BENCHMARK_TEMPLATE(BM_fastPath, SPSCCompact<tt, 1024>);
+BENCHMARK_TEMPLATE(BM_fastPath, SPSCInline<tt, 1024>);
+PROBES_BENCHMARK(16);
+PROBES_BENCHMARK(4096);
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    benchmark::AddCustomContext("USDT probes", QUEUE_PROBES_ENABLED ? "compiled in" : "compiled out");
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
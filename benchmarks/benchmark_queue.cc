@@ -4,7 +4,11 @@
 #include "SPSCWithRAPairs.hh"
 #include "SPSCWithoutFS.hh"
 #include "SPSCLocal.hh"
-// #include <boost/lockfree/spsc_queue.hpp>
+#include "MutexQueue.hh"
+#include "ProducerConsumerQueue.hh"
+#include "queue_adapter.hh"
+#include "thread_utils.hh"
+#include <boost/lockfree/spsc_queue.hpp>
 
 #include <benchmark/benchmark.h>
 
@@ -21,7 +25,6 @@
 // https://www.hybridkernel.com/2015/01/18/binding_threads_to_cores_osx.html
 
 #define SYSCTL_CORE_COUNT   "machdep.cpu.core_count"
-#define CACHE_LINE_SIZE     "hw.cachelinesize"
 
 // typedef struct cpu_set {
 //   uint32_t    count;
@@ -51,7 +54,7 @@
 // {
 //   int32_t core_count = 0;
 //   size_t  len = sizeof(core_count);
-//   int ret = sysctlbyname(CACHE_LINE_SIZE, &core_count, &len, 0, 0);
+//   int ret = sysctlbyname("hw.cachelinesize", &core_count, &len, 0, 0);
 //   if (ret) {
 //     std::cout << "error while get core count" << "sysctlbyname returned " << ret << std::endl;
 //     return ret;
@@ -82,38 +85,17 @@
 //   return 0;
 // }
 
-// Pinning of threads to a core is not supported in mac M1 chipset
-#ifdef APPLE_H
-    
-    static void pinThread(int cpu) {}
-
-#else
-
-    static void pinThread(int cpu) {
-        if (cpu < 0) {
-            return;
-        }
-        cpu_set_t cpuset;
-        CPU_ZERO(&cpuset);
-        CPU_SET(cpu, &cpuset);
-        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == -1) {
-            std::perror("pthread_setaffinity_rp");
-            std::exit(EXIT_FAILURE);
-        }
-    }
-
-#endif
-
 static constexpr int fifoSize = 131072; // 2048 * 8 * 8
 
 template<typename T>
 static void BM_queue(benchmark::State& state) {
 
     constexpr long iterations = 10'000'000l;
-    T fifo;
+    auto queue = makeQueue<T>(fifoSize);
+    auto& fifo = *queue;
     using queue_value_type = typename T::value_type;
 
-    const int cap = fifo.capacity();
+    const int cap = static_cast<int>(queueCapacity(fifo));
 
    // jthread are missing part of mac OS hence reverting back to thread
    auto th = std::thread([&] {
@@ -123,7 +105,7 @@ static void BM_queue(benchmark::State& state) {
         // pop warmup
         for (auto i = queue_value_type{}; i < cap; ++i) {
             queue_value_type val;
-            while (not fifo.pop(val)) {
+            while (not tryPop(fifo, val)) {
                     ;
             }
             benchmark::DoNotOptimize(val);
@@ -138,7 +120,7 @@ static void BM_queue(benchmark::State& state) {
         // pop benchmark run
         for (auto i = queue_value_type{}; i < iterations; ++i) {
             queue_value_type val;
-            while (not fifo.pop(val)) {
+            while (not tryPop(fifo, val)) {
                     ;
             }
             benchmark::DoNotOptimize(val);
@@ -153,12 +135,12 @@ static void BM_queue(benchmark::State& state) {
 
     // push warmup
     for (auto i = queue_value_type{}; i < cap; ++i) {
-        while (auto again = not fifo.push(i)) {
+        while (auto again = not tryPush(fifo, i)) {
             benchmark::DoNotOptimize(again);
         }
     }
 
-    while (auto again = not fifo.empty()) {
+    while (auto again = not queueEmpty(fifo)) {
         benchmark::DoNotOptimize(again);
     }
 
@@ -168,12 +150,12 @@ static void BM_queue(benchmark::State& state) {
             // auto start = std::chrono::high_resolution_clock::now();
         // push warmup
         for (auto i = queue_value_type{}; i < iterations; ++i) {
-            while (auto again = not fifo.push(i)) {
+            while (auto again = not tryPush(fifo, i)) {
                 benchmark::DoNotOptimize(again);
             }
         }
 
-        while (auto again = not fifo.empty()) {
+        while (auto again = not queueEmpty(fifo)) {
             benchmark::DoNotOptimize(again);
         }
 
@@ -208,6 +190,9 @@ using tt = std::int64_t;
 // BENCHMARK_TEMPLATE(BM_queue, SPSCWithRAPairs<tt, fifoSize>) -> Unit(benchmark::kMicrosecond);
 // BENCHMARK_TEMPLATE(BM_queue, SPSCWithoutFS<tt, fifoSize>) -> Unit(benchmark::kMicrosecond);
 BENCHMARK_TEMPLATE(BM_queue, SPSCLocal<tt, fifoSize>) -> Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_queue, boost::lockfree::spsc_queue<tt, boost::lockfree::capacity<fifoSize>>) -> Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_queue, folly::ProducerConsumerQueue<tt>) -> Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_queue, MutexQueue<tt>) -> Unit(benchmark::kMicrosecond);
 
 
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,119 @@
+// queue imports
+#include "ReservedAllocator.hh"
+#include "SPSCLocal.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include <unistd.h>
+
+using tt = std::int64_t;
+using namespace std::chrono_literals;
+
+/// 32 MiB of int64 slots: sized for bursts, idle most of the time
+static constexpr int fifoSize = 1 << 22;
+static constexpr std::int64_t iterations = 10'000'000;
+
+using CommittedFifo = SPSCLocal<tt, fifoSize>;
+using ReservedFifo = SPSCLocal<tt, fifoSize, ReservedAllocator<tt>>;
+using LazyFifo = SPSCLocal<tt, fifoSize, ReservedAllocator<tt, ReclaimAdvice::Free>>;
+
+/// Resident set size of the process from /proc/self/statm
+static double processRssMiB() {
+    std::ifstream statm{"/proc/self/statm"};
+    std::size_t size = 0;
+    std::size_t resident = 0;
+    statm >> size >> resident;
+    return double(resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))) / double(1 << 20);
+}
+
+/// Pops `count` elements; with `Reclaim` the consumer polls an IdleReclaimer whenever the
+/// queue is empty, as an idle loop would
+template<bool Reclaim, typename Fifo>
+static void popAll(Fifo& fifo, std::int64_t count) {
+    auto pop = [&](auto&& idle) {
+        tt value;
+        for (auto i = std::int64_t{}; i < count;) {
+            if (fifo.pop(value)) {
+                benchmark::DoNotOptimize(value);
+                ++i;
+            } else {
+                idle();
+            }
+        }
+    };
+    if constexpr (Reclaim) {
+        IdleReclaimer reclaimer{fifo, 1024, 1ms};
+        pop([&] { reclaimer.poll(); });
+    } else {
+        pop([] {});
+    }
+}
+
+/// Steady-state producer/consumer throughput: the cost of the page handshake on the
+/// producer, and of reclaiming on a consumer that keeps catching up with it
+template<typename Fifo, bool Reclaim>
+static void BM_steady(benchmark::State& state) {
+    auto fifo = std::make_unique<Fifo>();
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        std::thread consumer{[&] { popAll<Reclaim>(*fifo, iterations); }};
+        for (auto i = std::int64_t{}; i < iterations;) {
+            i += fifo->push(i);
+        }
+        consumer.join();
+        state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    state.counters["ops/sec"] = benchmark::Counter(double(iterations * state.iterations()), benchmark::Counter::kIsRate);
+    if constexpr (Fifo::reclaimable) {
+        state.counters["ring_resident_mib"] = double(fifo->residentBytes()) / double(1 << 20);
+    }
+}
+
+/// One burst that fills the whole ring, a full drain, then a quiet period: process RSS
+/// growth after the drain, and after reclaim() where the allocator supports it
+template<typename Fifo>
+static void BM_burst(benchmark::State& state) {
+    double drainedMiB = 0;
+    double reclaimedMiB = 0;
+    double reclaimUs = 0;
+    for (auto _ : state) {
+        auto before = processRssMiB();
+        auto fifo = std::make_unique<Fifo>();
+        auto capacity = static_cast<std::int64_t>(fifo->capacity());
+        for (auto i = std::int64_t{}; i < capacity; ++i) {
+            fifo->push(i);
+        }
+        tt value;
+        while (fifo->pop(value)) {
+            benchmark::DoNotOptimize(value);
+        }
+        drainedMiB = processRssMiB() - before;
+        reclaimedMiB = drainedMiB;
+        if constexpr (Fifo::reclaimable) {
+            auto start = std::chrono::steady_clock::now();
+            fifo->reclaim();
+            reclaimUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            reclaimedMiB = processRssMiB() - before;
+        }
+    }
+    state.counters["rss_drained_mib"] = drainedMiB;
+    state.counters["rss_reclaimed_mib"] = reclaimedMiB;
+    state.counters["reclaim_us"] = reclaimUs;
+}
+
+BENCHMARK_TEMPLATE(BM_steady, CommittedFifo, false) -> UseManualTime() -> Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_steady, ReservedFifo, false) -> UseManualTime() -> Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_steady, ReservedFifo, true) -> UseManualTime() -> Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_steady, LazyFifo, true) -> UseManualTime() -> Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_burst, CommittedFifo) -> Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_burst, ReservedFifo) -> Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_burst, LazyFifo) -> Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+// queue imports
+#include "Reorderer.hh"
+#include "SPSCLocal.hh"
+#include "latency_stats.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+/// A result carries the time its worker finished it, so the consumer can tell how long
+/// it waited for reordering
+struct Result {
+    std::int64_t completedNs;
+};
+
+static constexpr std::uint64_t items = 500'000;
+static constexpr std::size_t workQueueSize = 1 << 10;
+
+/// The std::map reorder buffer it replaces, behind the same worker queues
+class MapReorderer
+{
+public:
+    explicit MapReorderer(std::size_t workers) : count_{workers}, queues_{new Queue[workers]} {}
+
+    bool push(std::size_t worker, std::uint64_t sequence, const Result& value) {
+        return queues_[worker].push(Sequenced<Result>{sequence, value});
+    }
+
+    template<typename F>
+    std::size_t poll(F&& f) {
+        std::size_t delivered = 0;
+        Sequenced<Result> item;
+        for (std::size_t worker = 0; worker < count_; ++worker) {
+            while (queues_[worker].pop(item)) {
+                pending_.emplace(item.sequence, item.value);
+            }
+        }
+        for (auto it = pending_.begin(); it != pending_.end() and it->first == next_; it = pending_.erase(it)) {
+            f(next_++, it->second);
+            ++delivered;
+        }
+        return delivered;
+    }
+
+private:
+    using Queue = SPSCLocal<Sequenced<Result>, 1 << 12>;
+
+    std::size_t count_;
+    std::unique_ptr<Queue[]> queues_;
+    std::map<std::uint64_t, Result> pending_;
+    std::uint64_t next_{0};
+};
+
+/// Round-robin dispatch of `items` sequence numbers to range(0) workers over SPSC work
+/// queues. Each worker spins for a random 0-2000 iterations per item and hands the result
+/// to the reorder stage on its own queue; the consumer reports in-order throughput and
+/// the time results spend waiting for earlier ones.
+template<typename Reorder>
+static void BM_reorder(benchmark::State& state) {
+    const auto workers = static_cast<std::size_t>(state.range(0));
+    LatencySamples waited{items};
+
+    for (auto _ : state) {
+        using WorkQueue = SPSCLocal<std::uint64_t, workQueueSize>;
+        auto work = std::make_unique<WorkQueue[]>(workers);
+        Reorder reorder{workers};
+        std::atomic<bool> done{false};
+        waited.clear();
+
+        std::vector<std::thread> threads;
+        for (auto w = std::size_t{}; w < workers; ++w) {
+            threads.emplace_back([&, w] {
+                std::mt19937 rng{static_cast<unsigned>(w)};
+                std::uniform_int_distribution<int> service{0, 2000};
+                std::uint64_t sequence;
+                while (true) {
+                    if (not work[w].pop(sequence)) {
+                        if (done.load(std::memory_order_acquire) and work[w].empty()) {
+                            break;
+                        }
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    for (auto spin = service(rng); spin > 0; --spin) {
+                        benchmark::DoNotOptimize(spin);
+                    }
+                    while (not reorder.push(w, sequence, Result{nowNs()})) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        auto emit = [&](std::uint64_t, const Result& result) { waited.record(nowNs() - result.completedNs); };
+        auto start = nowNs();
+        std::uint64_t emitted = 0;
+        for (auto sequence = std::uint64_t{}; sequence < items; ++sequence) {
+            while (not work[sequence % workers].push(sequence)) {
+                emitted += reorder.poll(emit);
+            }
+            emitted += reorder.poll(emit);
+        }
+        done.store(true, std::memory_order_release);
+        while (emitted < items) {
+            emitted += reorder.poll(emit);
+        }
+        state.SetIterationTime(double(nowNs() - start) / 1e9);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    state.counters["items/sec"] = benchmark::Counter(double(items * state.iterations()), benchmark::Counter::kIsRate);
+    state.counters["wait_p50_ns"] = waited.percentile(50);
+    state.counters["wait_p99_ns"] = waited.percentile(99);
+    state.counters["wait_max_ns"] = waited.max();
+}
+
+BENCHMARK_TEMPLATE(BM_reorder, Reorderer<Result, 4096>) -> ArgName("workers") -> RangeMultiplier(2) -> Range(2, 16)
+    -> UseManualTime() -> Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_reorder, MapReorderer) -> ArgName("workers") -> RangeMultiplier(2) -> Range(2, 16)
+    -> UseManualTime() -> Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
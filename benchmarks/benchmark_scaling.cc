@@ -0,0 +1,161 @@
+// queue imports
+#include "BasicSPSC.hh"
+#include "BasicSPSCWithoutModulo.hh"
+#include "MutexQueue.hh"
+#include "ProducerConsumerQueue.hh"
+#include "SPSCLocal.hh"
+#include "SPSCWithRAPairs.hh"
+#include "SPSCWithoutFS.hh"
+#include "fifo4.hh"
+#include "latency_stats.hh"
+#include "perf_counter.hh"
+#include "queue_adapter.hh"
+#include "rigtorp.hpp"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using tt = std::int64_t;
+
+static constexpr int fifoSize = 1 << 14;
+static constexpr std::int64_t items = 1'000'000;
+/// Every latencyStride-th item carries a send timestamp; timing every item would
+/// measure the clock rather than the queue
+static constexpr std::int64_t latencyStride = 64;
+
+static int cpuCount() {
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+/// What one producer/consumer pair measured
+struct PairResult {
+    std::int64_t elapsedNs;
+    LatencySamples latency{items / latencyStride + 1};
+};
+
+/// Moves `items` values through `queue`, producer on `producerCpu` and consumer on
+/// `consumerCpu`, both released by `go` so all pairs contend from the same instant
+template<typename Q>
+static void runPair(Q& queue, int producerCpu, int consumerCpu, std::atomic<bool>& go, PairResult& result) {
+    std::thread consumer{[&] {
+        pinThread(consumerCpu);
+        while (not go.load(std::memory_order_acquire)) {
+            ;
+        }
+        tt value;
+        for (auto i = std::int64_t{}; i < items; ++i) {
+            while (not tryPop(queue, value)) {
+                ;
+            }
+            if (i % latencyStride == 0) {
+                result.latency.record(nowNs() - value);
+            }
+        }
+    }};
+
+    pinThread(producerCpu);
+    while (not go.load(std::memory_order_acquire)) {
+        ;
+    }
+    auto start = nowNs();
+    for (auto i = std::int64_t{}; i < items; ++i) {
+        tt value = i % latencyStride == 0 ? nowNs() : i;
+        while (not tryPush(queue, value)) {
+            ;
+        }
+    }
+    consumer.join();
+    result.elapsedNs = nowNs() - start;
+}
+
+/// range(0): K independent pairs; pair k runs on cpus 2k and 2k + 1 (modulo the cpu count)
+template<typename Q>
+static void BM_scaling(benchmark::State& state) {
+    const auto pairs = static_cast<int>(state.range(0));
+    const auto ncpus = cpuCount();
+
+    PerfCounter llcReferences{PerfEvent::LlcReferences};
+    PerfCounter llcMisses{PerfEvent::LlcMisses};
+    std::int64_t references = 0;
+    std::int64_t misses = 0;
+
+    LatencySamples latency{static_cast<std::size_t>(pairs * (items / latencyStride + 1))};
+    std::vector<double> pairRates;
+    std::int64_t moved = 0;
+    for (auto _ : state) {
+        std::vector<std::unique_ptr<Q>> queues;
+        for (auto k = 0; k < pairs; ++k) {
+            queues.push_back(makeQueue<Q>(fifoSize));
+        }
+        std::vector<PairResult> results(pairs);
+        std::atomic<bool> go{false};
+
+        llcReferences.start();
+        llcMisses.start();
+        std::vector<std::thread> producers;
+        for (auto k = 0; k < pairs; ++k) {
+            producers.emplace_back([&, k] {
+                runPair(*queues[k], (2 * k) % ncpus, (2 * k + 1) % ncpus, go, results[k]);
+            });
+        }
+        auto start = nowNs();
+        go.store(true, std::memory_order_release);
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        state.SetIterationTime(double(nowNs() - start) / 1e9);
+        references += llcReferences.stop();
+        misses += llcMisses.stop();
+
+        for (auto& result : results) {
+            pairRates.push_back(double(items) * 1e9 / double(std::max<std::int64_t>(1, result.elapsedNs)));
+            latency.merge(result.latency);
+        }
+        moved += pairs * items;
+    }
+
+    std::sort(pairRates.begin(), pairRates.end());
+    state.counters["ops/sec"] = benchmark::Counter(double(moved), benchmark::Counter::kIsRate);
+    state.counters["pair_ops/sec_min"] = pairRates.front();
+    state.counters["pair_ops/sec_median"] = pairRates[pairRates.size() / 2];
+    state.counters["p50_ns"] = latency.percentile(50);
+    state.counters["p99_ns"] = latency.percentile(99);
+    state.counters["p999_ns"] = latency.percentile(99.9);
+    // Reported as -1 where perf_event_open is not permitted
+    auto available = llcReferences.valid() and llcMisses.valid();
+    state.counters["llc_miss_pct"] = available and references > 0 ? 100.0 * double(misses) / double(references) : -1;
+    state.counters["llc_misses/op"] = available ? double(misses) / double(moved) : -1;
+}
+
+static void pairCounts(benchmark::internal::Benchmark* bench) {
+    bench->ArgName("pairs");
+    const auto maxPairs = std::max(1, cpuCount() / 2);
+    for (auto k = 1; k < maxPairs; k *= 2) {
+        bench->Arg(k);
+    }
+    bench->Arg(maxPairs);
+}
+
+#define SCALING_BENCHMARK(...) \
+    BENCHMARK_TEMPLATE(BM_scaling, __VA_ARGS__) -> Apply(pairCounts) -> UseManualTime() -> Unit(benchmark::kMillisecond)
+
+SCALING_BENCHMARK(BasicSPSC<tt, fifoSize>);
+SCALING_BENCHMARK(BasicSPSCWithoutModulo<tt, fifoSize>);
+SCALING_BENCHMARK(SPSCWithRAPairs<tt, fifoSize>);
+SCALING_BENCHMARK(SPSCWithoutFS<tt, fifoSize>);
+SCALING_BENCHMARK(SPSCLocal<tt, fifoSize>);
+SCALING_BENCHMARK(Fifo4a<tt>);
+SCALING_BENCHMARK(rigtorp::SPSCQueue<tt>);
+SCALING_BENCHMARK(boost::lockfree::spsc_queue<tt, boost::lockfree::capacity<fifoSize>>);
+SCALING_BENCHMARK(folly::ProducerConsumerQueue<tt>);
+SCALING_BENCHMARK(MutexQueue<tt>);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,97 @@
+// queue imports
+#include "SeqlockRing.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+static constexpr std::int64_t items = 1 << 22;
+
+/// Typical top-of-book update
+struct Quote {
+    std::int64_t seq;
+    std::int64_t price;
+    std::int64_t quantity;
+    std::int64_t timestampNs;
+};
+
+/// Producer throughput with range(0) readers attached. Readers consume as fast as they
+/// can; the producer never waits for them, so slow readers show up as lost messages.
+static void BM_seqlock_ring(benchmark::State& state) {
+    const auto readers = static_cast<int>(state.range(0));
+    const auto ncpus = std::max(1u, std::thread::hardware_concurrency());
+    std::int64_t published = 0;
+    std::uint64_t lost = 0;
+    std::uint64_t received = 0;
+    std::uint64_t disordered = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        SeqlockRing<Quote> ring;
+        std::atomic<bool> done{false};
+        std::atomic<int> ready{0};
+        std::vector<std::thread> threads;
+        std::vector<std::uint64_t> lostBy(readers), receivedBy(readers), disorderedBy(readers);
+        for (auto r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r] {
+                pinThread(static_cast<int>((r + 1) % ncpus));
+                auto reader = ring.reader();
+                ready.fetch_add(1, std::memory_order_release);
+                Quote quote;
+                std::int64_t last = -1;
+                while (true) {
+                    // Load done first so no message published before it is missed
+                    auto finished = done.load(std::memory_order_acquire);
+                    while (reader.read(quote)) {
+                        disorderedBy[r] += quote.seq <= last;
+                        last = quote.seq;
+                        ++receivedBy[r];
+                    }
+                    if (finished) {
+                        break;
+                    }
+                }
+                lostBy[r] = reader.lost();
+            });
+        }
+        while (ready.load(std::memory_order_acquire) < readers) {
+            ;
+        }
+        pinThread(0);
+        state.ResumeTiming();
+
+        for (auto i = std::int64_t{}; i < items; ++i) {
+            ring.push(Quote{i, 100 + (i & 15), i & 255, i});
+        }
+
+        state.PauseTiming();
+        done.store(true, std::memory_order_release);
+        for (auto& th : threads) {
+            th.join();
+        }
+        for (auto r = 0; r < readers; ++r) {
+            lost += lostBy[r];
+            received += receivedBy[r];
+            disordered += disorderedBy[r];
+        }
+        published += items;
+        state.ResumeTiming();
+    }
+
+    state.counters["ops/sec"] = benchmark::Counter(double(published), benchmark::Counter::kIsRate);
+    if (readers > 0) {
+        auto perReader = double(published) * readers;
+        state.counters["lost_pct"] = 100.0 * double(lost) / perReader;
+        state.counters["received_pct"] = 100.0 * double(received) / perReader;
+        state.counters["disordered"] = double(disordered);
+    }
+}
+
+// range(0): number of readers
+BENCHMARK(BM_seqlock_ring) -> DenseRange(0, 8) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+
+BENCHMARK_MAIN();
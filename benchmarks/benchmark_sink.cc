@@ -0,0 +1,127 @@
+// queue imports
+#include "BatchSink.hh"
+#include "SPSCLocal.hh"
+#include "latency_stats.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using Ring = SPSCLocal<std::byte, 1 << 16>;
+
+static constexpr std::size_t messageBytes = 64;
+static constexpr std::size_t messages = 200'000;
+
+/// Consumer strategies: range(0)
+enum Mode { WritePerMessage, Writev, Uring };
+/// Destinations: range(1)
+enum Target { File, Socket };
+
+/// File under $SINK_BENCH_DIR (default: the system temp directory), or one end of a
+/// socketpair whose other end a thread reads and discards
+class Destination
+{
+public:
+    explicit Destination(Target target) : target_{target} {
+        if (target == File) {
+            const char* base = std::getenv("SINK_BENCH_DIR");
+            path_ = std::filesystem::path{base ? base : std::filesystem::temp_directory_path().string()} / "benchmark_sink.bin";
+            fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        } else {
+            int fds[2];
+            ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds);
+            fd_ = fds[0];
+            peer_ = fds[1];
+            reader_ = std::thread{[this] {
+                auto buffer = std::make_unique<char[]>(1 << 16);
+                while (::read(peer_, buffer.get(), 1 << 16) > 0) {
+                }
+            }};
+        }
+    }
+
+    ~Destination() {
+        ::close(fd_);
+        if (target_ == File) {
+            std::filesystem::remove(path_);
+        } else {
+            reader_.join();
+            ::close(peer_);
+        }
+    }
+
+    /// Starts the next round on an empty file
+    void rewind() {
+        if (target_ == File) {
+            benchmark::DoNotOptimize(::ftruncate(fd_, 0));
+            ::lseek(fd_, 0, SEEK_SET);
+        }
+    }
+
+    int fd() const noexcept { return fd_; }
+
+private:
+    Target target_;
+    std::filesystem::path path_;
+    int fd_;
+    int peer_{-1};
+    std::thread reader_;
+};
+
+/// Messages of 64 bytes go through a 64 KiB byte ring; the consumer either write()s each
+/// message on its own, as the code it replaces does, or drains with a BatchSink. The clock
+/// stops once the last byte is handed to the kernel.
+static void BM_sink(benchmark::State& state) {
+    const auto mode = static_cast<Mode>(state.range(0));
+    Destination destination{static_cast<Target>(state.range(1))};
+    auto ring = std::make_unique<Ring>();
+    std::uint64_t syscalls = 0;
+    for (auto _ : state) {
+        destination.rewind();
+        auto start = nowNs();
+        std::thread producer{[&] {
+            for (std::size_t i = 0; i < messages;) {
+                auto span = ring->prepare(messageBytes);
+                if (span.size() == messageBytes) {
+                    span[0] = static_cast<std::byte>(i++);
+                    ring->commit(messageBytes);
+                }
+            }
+        }};
+        if (mode == WritePerMessage) {
+            for (std::size_t i = 0; i < messages;) {
+                auto span = ring->peek(messageBytes);
+                if (span.size() == messageBytes) {
+                    benchmark::DoNotOptimize(::write(destination.fd(), span.data(), messageBytes));
+                    ring->consume(messageBytes);
+                    ++syscalls;
+                    ++i;
+                }
+            }
+        } else {
+            BatchSink sink{*ring, destination.fd(), mode == Uring ? SinkBackend::Uring : SinkBackend::Writev};
+            while (sink.written() < messages * messageBytes) {
+                sink.poll();
+            }
+            syscalls += sink.syscalls();
+        }
+        producer.join();
+        state.SetIterationTime(double(nowNs() - start) / 1e9);
+    }
+    state.counters["msgs/sec"] = benchmark::Counter(double(messages * state.iterations()), benchmark::Counter::kIsRate);
+    state.counters["syscalls/msg"] = double(syscalls) / double(messages * state.iterations());
+}
+
+BENCHMARK(BM_sink) -> ArgNames({"mode", "target"}) -> ArgsProduct({{WritePerMessage, Writev, Uring}, {File, Socket}})
+    -> UseManualTime() -> Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
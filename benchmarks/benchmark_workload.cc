@@ -0,0 +1,92 @@
+// queue imports
+#include "BasicSPSC.hh"
+#include "BasicSPSCWithoutModulo.hh"
+#include "MutexQueue.hh"
+#include "ProducerConsumerQueue.hh"
+#include "SPSCLocal.hh"
+#include "SPSCWithRAPairs.hh"
+#include "SPSCWithoutFS.hh"
+#include "fifo4.hh"
+#include "rigtorp.hpp"
+#include "workload.hh"
+
+#include <benchmark/benchmark.h>
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <cstdint>
+#include <thread>
+
+using tt = std::int64_t;
+
+/// Small enough that bursts can fill it
+static constexpr int fifoSize = 4096;
+
+/// Consumer service time; the offered rate is a percentage of 1 / workNs
+static constexpr std::int64_t workNs = 500;
+
+/// range(0): offered load in percent of the consumer's capacity; range(1): bytes touched per item
+template<typename Q, Arrival A, Overload O>
+static void BM_workload(benchmark::State& state) {
+    WorkloadConfig config;
+    config.arrival = A;
+    config.overload = O;
+    config.workNs = workNs;
+    config.rate = double(state.range(0)) / 100.0 * 1e9 / double(workNs);
+    config.touchBytes = static_cast<std::size_t>(state.range(1));
+    const auto ncpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    config.producerCpu = 1 % ncpus;
+    config.consumerCpu = 2 % ncpus;
+    const auto schedule = arrivalSchedule(config);
+
+    LatencySamples latency{static_cast<std::size_t>(config.items)};
+    std::int64_t delivered = 0;
+    std::int64_t dropped = 0;
+    std::int64_t blocked = 0;
+    for (auto _ : state) {
+        auto queue = makeQueue<Q>(fifoSize);
+        auto result = runWorkload(*queue, config, schedule);
+        state.SetIterationTime(double(result.elapsedNs) / 1e9);
+        latency = std::move(result.latency);
+        delivered += result.delivered;
+        dropped += result.dropped;
+        blocked += result.blocked;
+    }
+
+    const auto offered = double(config.items * state.iterations());
+    state.counters["ops/sec"] = benchmark::Counter(double(delivered), benchmark::Counter::kIsRate);
+    state.counters["p50_ns"] = latency.percentile(50);
+    state.counters["p99_ns"] = latency.percentile(99);
+    state.counters["p999_ns"] = latency.percentile(99.9);
+    state.counters["max_ns"] = latency.max();
+    state.counters["dropped_pct"] = 100.0 * double(dropped) / offered;
+    state.counters["blocked_pct"] = 100.0 * double(blocked) / offered;
+}
+
+static void loads(benchmark::internal::Benchmark* bench) {
+    bench->ArgNames({"load_pct", "touch_bytes"});
+    for (auto touch : {0, 4096}) {
+        for (auto load : {10, 40, 70}) {
+            bench->Args({load, touch});
+        }
+    }
+}
+
+#define WORKLOAD_BENCHMARKS(...)                                                                                         \
+    BENCHMARK_TEMPLATE(BM_workload, __VA_ARGS__, Arrival::Constant, Overload::Backpressure) -> Apply(loads) -> UseManualTime() -> Unit(benchmark::kMillisecond); \
+    BENCHMARK_TEMPLATE(BM_workload, __VA_ARGS__, Arrival::OnOff, Overload::Backpressure) -> Apply(loads) -> UseManualTime() -> Unit(benchmark::kMillisecond);    \
+    BENCHMARK_TEMPLATE(BM_workload, __VA_ARGS__, Arrival::OnOff, Overload::Drop) -> Apply(loads) -> UseManualTime() -> Unit(benchmark::kMillisecond);            \
+    BENCHMARK_TEMPLATE(BM_workload, __VA_ARGS__, Arrival::Poisson, Overload::Backpressure) -> Apply(loads) -> UseManualTime() -> Unit(benchmark::kMillisecond);  \
+    BENCHMARK_TEMPLATE(BM_workload, __VA_ARGS__, Arrival::Poisson, Overload::Drop) -> Apply(loads) -> UseManualTime() -> Unit(benchmark::kMillisecond)
+
+WORKLOAD_BENCHMARKS(BasicSPSC<tt, fifoSize>);
+WORKLOAD_BENCHMARKS(BasicSPSCWithoutModulo<tt, fifoSize>);
+WORKLOAD_BENCHMARKS(SPSCWithRAPairs<tt, fifoSize>);
+WORKLOAD_BENCHMARKS(SPSCWithoutFS<tt, fifoSize>);
+WORKLOAD_BENCHMARKS(SPSCLocal<tt, fifoSize>);
+WORKLOAD_BENCHMARKS(Fifo4a<tt>);
+WORKLOAD_BENCHMARKS(rigtorp::SPSCQueue<tt>);
+WORKLOAD_BENCHMARKS(boost::lockfree::spsc_queue<tt, boost::lockfree::capacity<fifoSize>>);
+WORKLOAD_BENCHMARKS(folly::ProducerConsumerQueue<tt>);
+WORKLOAD_BENCHMARKS(MutexQueue<tt>);
+
+BENCHMARK_MAIN();
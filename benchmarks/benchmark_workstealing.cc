@@ -0,0 +1,177 @@
+// queue imports
+#include "BoundedMPMC.hh"
+#include "WorkStealingPool.hh"
+#include "thread_utils.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/// Leaf tasks per iteration; each one does a few nanoseconds of work
+static constexpr std::int64_t leaves = 1 << 20;
+
+/// Pool whose workers all pop from one shared MPMC ring
+class CentralPool
+{
+public:
+    explicit CentralPool(std::size_t workers, std::vector<int> cpus = {})
+        : count_{workers}
+    {
+        for (auto k = std::size_t{}; k < workers; ++k) {
+            auto cpu = k < cpus.size() ? cpus[k] : -1;
+            threads_.emplace_back([this, k, cpu] { run(k, cpu); });
+        }
+    }
+
+    ~CentralPool() { stop(); }
+
+    std::size_t workers() const noexcept { return count_; }
+
+    int workerIndex() const noexcept { return current_.pool == this ? current_.index : -1; }
+
+    void submit(Task* task) {
+        while (not queue_.push(task)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void stop() {
+        stop_.store(true, std::memory_order_relaxed);
+        for (auto& th : threads_) {
+            if (th.joinable()) {
+                th.join();
+            }
+        }
+    }
+
+private:
+    struct Current {
+        CentralPool* pool;
+        int index;
+    };
+
+    void run(std::size_t self, int cpu) {
+        pinThread(cpu);
+        current_ = Current{this, static_cast<int>(self)};
+        Task* task;
+        unsigned idle = 0;
+        while (not stop_.load(std::memory_order_relaxed)) {
+            if (queue_.pop(task)) {
+                task->execute();
+                idle = 0;
+            } else if (++idle > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::size_t count_;
+    std::vector<std::thread> threads_;
+    BoundedMPMC<Task*, 1 << 21> queue_;
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> stop_{false};
+
+    inline static thread_local Current current_;
+};
+
+/// Completed leaves per worker, each on its own cache line; only the worker writes its counter
+struct alignas(CACHE_LINE_SIZE) Counter {
+    std::atomic<std::int64_t> value{0};
+};
+
+/// Splits [begin, end) in halves until one leaf remains. The whole tree is preallocated in
+/// heap order so no allocation happens while measuring.
+template<typename Pool>
+struct RangeTask : Task {
+    Pool* pool;
+    RangeTask* tree;
+    Counter* counters;
+    std::int64_t node;
+    std::int64_t begin;
+    std::int64_t end;
+
+    RangeTask(Pool* p, Counter* c) : pool{p}, tree{nullptr}, counters{c}, node{0}, begin{0}, end{0} {}
+
+    void execute() override {
+        if (end - begin > 1) {
+            auto middle = begin + (end - begin) / 2;
+            auto& left = tree[2 * node + 1];
+            auto& right = tree[2 * node + 2];
+            left.reset(2 * node + 1, begin, middle);
+            right.reset(2 * node + 2, middle, end);
+            pool->submit(&right);
+            pool->submit(&left);
+            return;
+        }
+        auto x = static_cast<std::uint64_t>(begin);
+        for (auto i = 0; i < 16; ++i) {
+            x = x * 6364136223846793005u + 1442695040888963407u;
+        }
+        benchmark::DoNotOptimize(x);
+        auto& counter = counters[pool->workerIndex()].value;
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void reset(std::int64_t n, std::int64_t b, std::int64_t e) {
+        node = n;
+        begin = b;
+        end = e;
+    }
+};
+
+static std::vector<int> workerCpus(std::size_t workers) {
+    std::vector<int> cpus;
+    for (auto k = std::size_t{}; k < workers; ++k) {
+        cpus.push_back(static_cast<int>(k % std::max(1u, std::thread::hardware_concurrency())));
+    }
+    return cpus;
+}
+
+/// range(0) workers run one tree of `leaves` fine-grained tasks per iteration
+template<typename Pool>
+static void BM_tasks(benchmark::State& state) {
+    const auto workers = static_cast<std::size_t>(state.range(0));
+    Pool pool{workers, workerCpus(workers)};
+    auto counters = std::make_unique<Counter[]>(workers);
+    std::vector<RangeTask<Pool>> tree(2 * leaves - 1, RangeTask<Pool>{&pool, counters.get()});
+    for (auto& task : tree) {
+        task.tree = tree.data();
+    }
+
+    std::int64_t executed = 0;
+    std::int64_t target = 0;
+    for (auto _ : state) {
+        target += leaves;
+        tree[0].reset(0, 0, leaves);
+        pool.submit(&tree[0]);
+
+        std::int64_t done;
+        do {
+            done = 0;
+            for (auto k = std::size_t{}; k < workers; ++k) {
+                done += counters[k].value.load(std::memory_order_acquire);
+            }
+        } while (done < target);
+        executed += 2 * leaves - 1;
+    }
+    pool.stop();
+
+    state.counters["tasks/sec"] = benchmark::Counter(double(executed), benchmark::Counter::kIsRate);
+}
+
+static void workerCounts(benchmark::internal::Benchmark* bench) {
+    const auto ncpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (auto workers = 1; workers < ncpus; workers *= 2) {
+        bench->Arg(workers);
+    }
+    bench->Arg(ncpus);
+}
+
+// range(0): number of worker threads, 1 up to every core
+BENCHMARK_TEMPLATE(BM_tasks, WorkStealingPool) -> Apply(workerCounts) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+BENCHMARK_TEMPLATE(BM_tasks, CentralPool) -> Apply(workerCounts) -> Unit(benchmark::kMillisecond) -> UseRealTime();
+
+BENCHMARK_MAIN();
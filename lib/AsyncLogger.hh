@@ -0,0 +1,323 @@
+#pragma once
+
+#include "MirroredAllocator.hh"
+#include "SPSCLocal.hh"
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/// What log() does when the calling thread's ring is full
+enum class LogOverflow { Drop, Block };
+
+/// Arguments a hot thread may hand to the logger: copied as raw bytes and formatted later
+template<typename T>
+concept LogArgument = std::is_trivially_copyable_v<T> and (std::is_arithmetic_v<T> or std::is_enum_v<T>);
+
+/// Appends the text of one argument; enums print their underlying value
+template<LogArgument T>
+inline void appendLogArgument(std::string& out, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out += value ? "true" : "false";
+    } else if constexpr (std::is_same_v<T, char>) {
+        out += value;
+    } else if constexpr (std::is_enum_v<T>) {
+        appendLogArgument(out, static_cast<std::underlying_type_t<T>>(value));
+    } else {
+        char buffer[64];
+        auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, error == std::errc{} ? end : buffer);
+    }
+}
+
+/// Type-erased part of a LogSite; its address is the format ID stored in each record
+struct LogSiteBase {
+    const char* format;
+    void (*render)(std::string& out, const char* format, const std::byte* arguments);
+};
+
+/// One log statement: a format string with `{}` placeholders (`{{` and `}}` for braces)
+/// and the argument types it is called with. Define it static so its address identifies
+/// the statement for the lifetime of the process, or use ASYNC_LOG.
+template<LogArgument... Args>
+struct LogSite : LogSiteBase {
+    static constexpr std::size_t argumentBytes = (std::size_t{} + ... + sizeof(Args));
+
+    constexpr explicit LogSite(const char* format) noexcept : LogSiteBase{format, &renderRecord} {}
+
+private:
+    static void renderRecord(std::string& out, const char* format, const std::byte* arguments) {
+        // Arguments are packed back to back without alignment
+        std::tuple<Args...> values;
+        std::apply([&](auto&... value) { ((std::memcpy(&value, arguments, sizeof(value)), arguments += sizeof(value)), ...); },
+                   values);
+        std::apply([&](const auto&... value) { renderFormat(out, format, value...); }, values);
+    }
+
+    template<typename... Values>
+    static void renderFormat(std::string& out, const char* format, const Values&... values) {
+        std::size_t next = 0;
+        auto argument = [&](std::size_t index) {
+            std::size_t i = 0;
+            ((i++ == index ? appendLogArgument(out, values) : void()), ...);
+        };
+        for (const char* c = format; *c; ++c) {
+            if ((c[0] == '{' and c[1] == '{') or (c[0] == '}' and c[1] == '}')) {
+                out += *c++;
+            } else if (c[0] == '{' and c[1] == '}') {
+                argument(next++);
+                ++c;
+            } else {
+                out += *c;
+            }
+        }
+    }
+};
+
+/// Asynchronous logger: each logging thread owns an SPSCLocal byte ring (mirrored, so a
+/// record is always contiguous) and only copies a record into it, consisting of the
+/// LogSite address, a timestamp and the raw argument bytes. A background thread parses the
+/// records in place, formats them and appends the lines to a file with one write() per
+/// batch. The ring of a thread is created on its first log() and kept until the logger is
+/// destroyed, which drains every ring and writes the rest out.
+template<int RingBytes = 1 << 20>
+class AsyncLogger
+{
+public:
+    using ring_type = SPSCLocal<std::byte, RingBytes, MirroredAllocator<std::byte>>;
+
+    /// Appends to `path`, creating it if needed.
+    /// @throw std::system_error if the file cannot be opened.
+    explicit AsyncLogger(const std::filesystem::path& path, LogOverflow overflow = LogOverflow::Drop,
+                         std::chrono::microseconds idle = std::chrono::microseconds{50})
+        : overflow_{overflow}
+        , idle_{idle}
+        , id_{nextId().fetch_add(1, std::memory_order_relaxed) + 1}
+        , fd_{::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644)}
+    {
+        if (fd_ == -1) {
+            throw std::system_error(errno, std::system_category(), "open " + path.string());
+        }
+        backend_ = std::thread{[this] { run(); }};
+    }
+
+    AsyncLogger(AsyncLogger const&) = delete;
+    AsyncLogger& operator=(AsyncLogger const&) = delete;
+
+    ~AsyncLogger() {
+        stop_.store(true, std::memory_order_release);
+        backend_.join();
+        ::close(fd_);
+    }
+
+    /// Enqueues one record for `site` on the calling thread's ring; no formatting, no system call.
+    /// @return `false` if the record was dropped because the ring was full (LogOverflow::Drop).
+    template<LogArgument... Args>
+    bool log(const LogSite<Args...>& site, const std::type_identity_t<Args>&... args) {
+        constexpr std::size_t size = sizeof(Header) + LogSite<Args...>::argumentBytes;
+        static_assert(size <= std::size_t(RingBytes));
+
+        auto& ring = localRing();
+        auto span = ring.prepare(size);
+        while (span.size() < size) {
+            if (overflow_ == LogOverflow::Drop) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            std::this_thread::yield();
+            span = ring.prepare(size);
+        }
+
+        Header header{static_cast<std::uint32_t>(size), &site, wallClockNs()};
+        auto* out = span.data();
+        std::memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        ((std::memcpy(out, &args, sizeof(args)), out += sizeof(args)), ...);
+        ring.commit(size);
+        return true;
+    }
+
+    /// Blocks until every record enqueued before the call, by any thread, is written to the file
+    void flush() {
+        auto request = flushRequests_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        while (flushed_.load(std::memory_order_acquire) < request) {
+            std::this_thread::yield();
+        }
+    }
+
+    /// Records dropped so far because a ring was full
+    std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+    /// Lines written to the file so far
+    std::uint64_t written() const noexcept { return written_.load(std::memory_order_relaxed); }
+
+private:
+    /// Fixed part of each record; the arguments follow unaligned
+    struct Header {
+        std::uint32_t size;
+        const LogSiteBase* site;
+        std::int64_t timestampNs;
+    };
+
+    /// The calling thread's ring in this logger; registration takes the lock once per thread
+    struct ThreadRing {
+        std::uint64_t owner;
+        ring_type* ring;
+    };
+
+    static std::atomic<std::uint64_t>& nextId() noexcept {
+        static std::atomic<std::uint64_t> id{0};
+        return id;
+    }
+
+    static std::int64_t wallClockNs() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    ring_type& localRing() {
+        if (current_.owner == id_) {
+            return *current_.ring;
+        }
+        std::lock_guard lock{mutex_};
+        auto self = std::this_thread::get_id();
+        ring_type* ring = nullptr;
+        for (auto& [thread, owned] : rings_) {
+            if (thread == self) {
+                ring = owned.get();
+            }
+        }
+        if (not ring) {
+            rings_.emplace_back(self, std::make_unique<ring_type>());
+            ring = rings_.back().second.get();
+            ringCount_.store(rings_.size(), std::memory_order_release);
+        }
+        current_.owner = id_;
+        current_.ring = ring;
+        return *ring;
+    }
+
+    /// Formats every complete record in `ring`, in place
+    std::size_t drain(ring_type& ring) {
+        auto records = ring.peek();
+        std::size_t offset = 0;
+        std::size_t lines = 0;
+        while (records.size() - offset >= sizeof(Header)) {
+            Header header;
+            std::memcpy(&header, records.data() + offset, sizeof(header));
+            auto seconds = header.timestampNs / 1'000'000'000;
+            auto nanos = header.timestampNs % 1'000'000'000;
+            buffer_ += '[';
+            appendLogArgument(buffer_, seconds);
+            buffer_ += '.';
+            auto digits = buffer_.size();
+            appendLogArgument(buffer_, nanos);
+            buffer_.insert(digits, 9 - (buffer_.size() - digits), '0');
+            buffer_ += "] ";
+            header.site->render(buffer_, header.site->format, records.data() + offset + sizeof(header));
+            buffer_ += '\n';
+            offset += header.size;
+            ++lines;
+            if (buffer_.size() >= batchBytes) {
+                writeBuffer();
+            }
+        }
+        ring.consume(offset);
+        return lines;
+    }
+
+    void writeBuffer() {
+        std::size_t done = 0;
+        while (done < buffer_.size()) {
+            auto n = ::write(fd_, buffer_.data() + done, buffer_.size() - done);
+            if (n == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                // Nowhere left to report to: the batch is lost
+                break;
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        buffer_.clear();
+    }
+
+    void run() {
+        std::vector<ring_type*> rings;
+        while (true) {
+            // Read both before draining so every record they cover is seen below
+            auto stopping = stop_.load(std::memory_order_acquire);
+            auto request = flushRequests_.load(std::memory_order_acquire);
+            if (ringCount_.load(std::memory_order_acquire) != rings.size()) {
+                std::lock_guard lock{mutex_};
+                rings.clear();
+                for (auto& entry : rings_) {
+                    rings.push_back(entry.second.get());
+                }
+            }
+
+            std::size_t lines = 0;
+            for (auto* ring : rings) {
+                lines += drain(*ring);
+            }
+            writeBuffer();
+            written_.fetch_add(lines, std::memory_order_relaxed);
+            flushed_.store(request, std::memory_order_release);
+
+            if (lines == 0) {
+                if (stopping) {
+                    return;
+                }
+                std::this_thread::sleep_for(idle_);
+            }
+        }
+    }
+
+    static constexpr std::size_t batchBytes = 64 << 10;
+
+    const LogOverflow overflow_;
+    const std::chrono::microseconds idle_;
+    const std::uint64_t id_;
+    int fd_;
+
+    std::mutex mutex_;
+    std::vector<std::pair<std::thread::id, std::unique_ptr<ring_type>>> rings_;
+    std::atomic<std::size_t> ringCount_{0};
+
+    std::atomic<bool> stop_{false};
+    std::atomic<std::uint64_t> flushRequests_{0};
+    std::atomic<std::uint64_t> flushed_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> written_{0};
+
+    /// Backend only
+    std::string buffer_;
+    std::thread backend_;
+
+    inline static thread_local ThreadRing current_;
+};
+
+/// Logs through a function-local static LogSite deduced from the arguments:
+/// `ASYNC_LOG(logger, "order {} filled at {}", id, price);`
+#define ASYNC_LOG(logger, format, ...)                                                     \
+    ([&]<typename... AsyncLogArgs>(const AsyncLogArgs&... asyncLogArgs) {                 \
+        static constexpr LogSite<AsyncLogArgs...> asyncLogSite{format};                   \
+        return (logger).log(asyncLogSite, asyncLogArgs...);                               \
+    }(__VA_ARGS__))
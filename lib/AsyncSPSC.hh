@@ -0,0 +1,187 @@
+#pragma once
+
+#include "SPSCLocal.hh"
+#include "executor.hh"
+#include "full_fence.hh"
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <memory>
+#include <utility>
+
+/// SPSCLocal with coroutine awaitables for push and pop.
+/// The awaitables complete synchronously while the fifo has room/elements. Otherwise the
+/// awaiting coroutine registers itself as the single waiter of its side and suspends; the
+/// other side resumes it (inline, or through a SingleThreadExecutor) after its cursor store.
+template<typename T, const int N = 1 << 17, typename Alloc = std::allocator<T>>
+class AsyncSPSC
+{
+public:
+    using fifo_type = SPSCLocal<T, N, Alloc>;
+    using value_type = T;
+    using size_type = typename fifo_type::size_type;
+
+    explicit AsyncSPSC(Alloc const& alloc = Alloc{})
+        : fifo_{alloc}
+    {}
+
+    AsyncSPSC(AsyncSPSC const&) = delete;
+    AsyncSPSC& operator=(AsyncSPSC const&) = delete;
+
+    /// Returns the number of elements in the fifo
+    auto size() const noexcept { return fifo_.size(); }
+
+    /// Returns whether the container has no elements
+    bool empty() const noexcept { return fifo_.empty(); }
+
+    /// Returns whether the container has capacity() elements
+    bool full() const noexcept { return fifo_.full(); }
+
+    /// Returns the number of elements that can be held in the fifo
+    size_type capacity() const noexcept { return fifo_.capacity(); }
+
+    /// Push one object onto the fifo and wake a suspended consumer.
+    /// @return `true` if the operation is successful; `false` if fifo is full.
+    bool push(const T& value) {
+        if (not fifo_.push(value)) {
+            return false;
+        }
+        wake(popWaiter_, [this] { return not fifo_.empty(); });
+        return true;
+    }
+
+    /// Pop one object from the fifo and wake a suspended producer.
+    /// @return `true` if the pop operation is successful; `false` if fifo is empty.
+    bool pop(T& value) {
+        if (not fifo_.pop(value)) {
+            return false;
+        }
+        wake(pushWaiter_, [this] { return not fifo_.full(); });
+        return true;
+    }
+
+    /// `co_await` pushes `value`, suspending while the fifo is full.
+    /// A suspended producer is resumed on `executor` when given, otherwise inline by the consumer.
+    auto async_push(T value, SingleThreadExecutor* executor = nullptr) {
+        return PushAwaiter{*this, std::move(value), executor};
+    }
+
+    /// `co_await` yields the next element, suspending while the fifo is empty.
+    /// A suspended consumer is resumed on `executor` when given, otherwise inline by the producer.
+    auto async_pop(SingleThreadExecutor* executor = nullptr) {
+        return PopAwaiter{*this, executor};
+    }
+
+private:
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        SingleThreadExecutor* executor;
+
+        void resume() const {
+            if (executor) {
+                executor->post(handle);
+            } else {
+                handle.resume();
+            }
+        }
+    };
+
+    using WaiterSlot = std::atomic<Waiter*>;
+    static_assert(WaiterSlot::is_always_lock_free);
+
+    /// Called after a successful cursor store; resumes the other side if it is suspended.
+    /// The fence pairs with the one in suspend(): either this load sees the registration or
+    /// the waiter's re-check sees the cursor store. Without a waiter the slot is only read,
+    /// so its line stays shared and the hot path makes no read-modify-write.
+    /// A wake lagging behind its cursor store can claim a newer registration that the store no
+    /// longer satisfies; the waiter is then put back, as nobody else can claim it meanwhile.
+    template<typename Ready>
+    static void wake(WaiterSlot& slot, Ready ready) {
+        fullFence();
+        if (slot.load(std::memory_order_relaxed) == nullptr) {
+            return;
+        }
+        auto* waiter = slot.exchange(nullptr, std::memory_order_acq_rel);
+        if (waiter == nullptr) {
+            return;
+        }
+        if (ready()) {
+            waiter->resume();
+        } else {
+            slot.store(waiter, std::memory_order_release);
+        }
+    }
+
+    /// Registers `waiter` and re-checks the fifo.
+    /// Once registered the coroutine may be resumed by the other thread at any time, so
+    /// `ready` only reads the cursors and nothing in the awaiter is touched afterwards.
+    /// @return `true` if the coroutine stays suspended.
+    template<typename Ready>
+    static bool suspend(WaiterSlot& slot, Waiter* waiter, Ready ready) {
+        slot.exchange(waiter, std::memory_order_acq_rel);
+        fullFence();
+        if (not ready()) {
+            return true;
+        }
+        // Take the registration back unless the other side already claimed it and will resume us
+        return slot.exchange(nullptr, std::memory_order_acq_rel) == nullptr;
+    }
+
+    struct PushAwaiter {
+        AsyncSPSC& queue;
+        T value;
+        SingleThreadExecutor* executor;
+        Waiter waiter{};
+        bool done{false};
+
+        bool await_ready() { return done = queue.push(value); }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            waiter = Waiter{handle, executor};
+            auto& fifo = queue.fifo_;
+            return suspend(queue.pushWaiter_, &waiter, [&fifo] { return not fifo.full(); });
+        }
+
+        void await_resume() {
+            if (not done) {
+                [[maybe_unused]] auto pushed = queue.push(value);
+                assert(pushed);
+            }
+        }
+    };
+
+    struct PopAwaiter {
+        AsyncSPSC& queue;
+        SingleThreadExecutor* executor;
+        Waiter waiter{};
+        T value{};
+        bool done{false};
+
+        bool await_ready() { return done = queue.pop(value); }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            waiter = Waiter{handle, executor};
+            auto& fifo = queue.fifo_;
+            return suspend(queue.popWaiter_, &waiter, [&fifo] { return not fifo.empty(); });
+        }
+
+        T await_resume() {
+            if (not done) {
+                [[maybe_unused]] auto popped = queue.pop(value);
+                assert(popped);
+            }
+            return std::move(value);
+        }
+    };
+
+    fifo_type fifo_;
+
+    /// Consumer suspended on an empty fifo; set by the pop side, claimed by the push side
+    alignas(CACHE_LINE_SIZE) WaiterSlot popWaiter_{nullptr};
+
+    /// Producer suspended on a full fifo; set by the push side, claimed by the pop side
+    alignas(CACHE_LINE_SIZE) WaiterSlot pushWaiter_{nullptr};
+
+    char padding_[CACHE_LINE_SIZE - sizeof(WaiterSlot)];
+};
@@ -0,0 +1,439 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define QUEUE_HAS_IO_URING 1
+#else
+#define QUEUE_HAS_IO_URING 0
+#endif
+
+/// How a BatchSink hands the ring's bytes to the kernel
+enum class SinkBackend { Writev, Uring };
+
+#if QUEUE_HAS_IO_URING
+/// Minimal io_uring on the raw system calls: one submission and one completion ring, with
+/// IORING_OP_WRITEV entries only. The rings are shared with the kernel, so head and tail
+/// are accessed through atomic_ref.
+class IoUring
+{
+public:
+    /// @throw std::system_error if the kernel refuses (ENOSYS, or EPERM under seccomp).
+    explicit IoUring(unsigned entries) {
+        io_uring_params params{};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ == -1) {
+            throw std::system_error(errno, std::system_category(), "io_uring_setup");
+        }
+        sqBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            sqBytes_ = cqBytes_ = std::max(sqBytes_, cqBytes_);
+        }
+        sqRing_ = map(sqBytes_, IORING_OFF_SQ_RING);
+        cqRing_ = params.features & IORING_FEAT_SINGLE_MMAP ? sqRing_ : map(cqBytes_, IORING_OFF_CQ_RING);
+        sqesBytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqesBytes_, IORING_OFF_SQES));
+
+        auto* sq = static_cast<std::byte*>(sqRing_);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+        auto* cq = static_cast<std::byte*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    IoUring(IoUring const&) = delete;
+    IoUring& operator=(IoUring const&) = delete;
+
+    ~IoUring() {
+        ::munmap(sqes_, sqesBytes_);
+        if (cqRing_ != sqRing_) {
+            ::munmap(cqRing_, cqBytes_);
+        }
+        ::munmap(sqRing_, sqBytes_);
+        ::close(fd_);
+    }
+
+    /// Queues a writev of `iov` at `offset` (-1: the file position); io_uring_enter() submits it
+    void prepareWritev(int fd, const iovec* iov, unsigned count, std::int64_t offset, std::uint64_t userData) noexcept {
+        unsigned tail = *sqTail_;
+        auto& sqe = sqes_[tail & sqMask_];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_WRITEV;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(iov);
+        sqe.len = count;
+        sqe.off = static_cast<std::uint64_t>(offset);
+        sqe.user_data = userData;
+        sqArray_[tail & sqMask_] = tail & sqMask_;
+        std::atomic_ref{*sqTail_}.store(tail + 1, std::memory_order_release);
+        ++pending_;
+    }
+
+    /// Submits the queued entries and, when `wait` is set, blocks for at least one completion
+    void enter(bool wait) {
+        while (true) {
+            auto submitted = ::syscall(__NR_io_uring_enter, fd_, pending_, wait ? 1u : 0u,
+                                       wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (submitted >= 0) {
+                pending_ -= static_cast<unsigned>(submitted);
+                return;
+            }
+            if (errno != EINTR) {
+                throw std::system_error(errno, std::system_category(), "io_uring_enter");
+            }
+        }
+    }
+
+    /// Calls `f(userData, result)` for every completion available, without a system call
+    template<typename F>
+    std::size_t reap(F&& f) {
+        unsigned head = *cqHead_;
+        unsigned tail = std::atomic_ref{*cqTail_}.load(std::memory_order_acquire);
+        for (unsigned i = head; i != tail; ++i) {
+            const auto& cqe = cqes_[i & cqMask_];
+            f(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref{*cqHead_}.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+    unsigned entries() const noexcept { return sqEntries_; }
+
+private:
+    void* map(std::size_t bytes, std::uint64_t offset) {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, static_cast<off_t>(offset));
+        if (p == MAP_FAILED) {
+            throw std::system_error(errno, std::system_category(), "mmap io_uring");
+        }
+        return p;
+    }
+
+    int fd_;
+    std::size_t sqBytes_;
+    std::size_t cqBytes_;
+    std::size_t sqesBytes_;
+    void* sqRing_;
+    void* cqRing_;
+    io_uring_sqe* sqes_;
+    unsigned* sqTail_;
+    unsigned sqMask_;
+    unsigned* sqArray_;
+    unsigned sqEntries_;
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned cqMask_;
+    io_uring_cqe* cqes_;
+    unsigned pending_{0};
+};
+#endif
+
+/// Consumer stage that drains a byte ring (SPSCLocal<std::byte, ...>) to a file or socket
+/// without copying: it gathers the readable bytes, at most `maxBatch` per write, into one
+/// or two iovecs (two when they wrap around a ring that is not mirrored) and hands them to
+/// writev(), or to io_uring with up to `depth` writes in flight. Bytes are consume()d only
+/// once the kernel reports them written, so a slow descriptor fills the ring and the
+/// producer's prepare()/push() starts failing: backpressure without another buffer.
+///
+/// The producer frames its messages; the sink only preserves the byte order. With io_uring,
+/// several writes are in flight only on a seekable descriptor not opened with O_APPEND,
+/// where each targets its own offset, starting at the file position; the position is moved
+/// past the written bytes on destruction. Sockets and pipes get one write at a time.
+/// If io_uring is unavailable (old kernel, seccomp) the sink falls back to writev.
+template<typename Ring>
+class BatchSink
+{
+public:
+    static_assert(sizeof(typename Ring::value_type) == 1, "the ring must carry bytes");
+
+    /// @throw std::system_error if a write fails with anything but EINTR or EAGAIN.
+    BatchSink(Ring& ring, int fd, SinkBackend backend = SinkBackend::Uring, std::size_t maxBatch = 256 << 10,
+              unsigned depth = 4)
+        : ring_{ring}
+        , fd_{fd}
+        , maxBatch_{maxBatch}
+        , backend_{backend}
+    {
+#if QUEUE_HAS_IO_URING
+        if (backend_ == SinkBackend::Uring) {
+            try {
+                uring_ = std::make_unique<IoUring>(std::max(depth, 1u));
+            } catch (const std::system_error&) {
+                backend_ = SinkBackend::Writev;
+            }
+        }
+        if (backend_ == SinkBackend::Uring) {
+            // Offset -1 writes at the file position (and appends, or sends) in submission order
+            offset_ = ::fcntl(fd_, F_GETFL) & O_APPEND ? -1 : ::lseek(fd_, 0, SEEK_CUR);
+            depth_ = offset_ != -1 ? std::max(depth, 1u) : 1;
+            writes_.resize(depth_);
+        }
+#else
+        backend_ = SinkBackend::Writev;
+#endif
+    }
+
+    BatchSink(BatchSink const&) = delete;
+    BatchSink& operator=(BatchSink const&) = delete;
+
+    /// Waits for the writes in flight, since the kernel reads from the ring
+    ~BatchSink() {
+#if QUEUE_HAS_IO_URING
+        if (backend_ == SinkBackend::Uring) {
+            try {
+                while (true) {
+                    if (error_ != 0) {
+                        // Completed, and nothing more is written after a failure
+                        inFlight_ -= static_cast<unsigned>(resubmit_.size());
+                    } else {
+                        for (auto index : resubmit_) {
+                            submit(writes_[index]);
+                        }
+                    }
+                    resubmit_.clear();
+                    if (inFlight_ == 0) {
+                        break;
+                    }
+                    uring_->enter(true);
+                    reap();
+                }
+            } catch (const std::system_error&) {
+            }
+            release();
+            if (offset_ != -1) {
+                ::lseek(fd_, offset_, SEEK_SET);
+            }
+        }
+#endif
+    }
+
+    /// Releases the bytes whose writes completed and starts writing what the producer
+    /// published since; never blocks on the descriptor beyond the write itself.
+    /// @return the number of bytes released to the producer.
+    std::size_t poll() {
+#if QUEUE_HAS_IO_URING
+        if (backend_ == SinkBackend::Uring) {
+            return pollUring(false);
+        }
+#endif
+        return pollWritev();
+    }
+
+    /// Writes until the ring is empty and no write is in flight
+    void flush() {
+        while (true) {
+            poll();
+            if (busy() == 0 and ring_.peek(1).empty()) {
+                return;
+            }
+#if QUEUE_HAS_IO_URING
+            if (backend_ == SinkBackend::Uring and inFlight_ > 0) {
+                pollUring(true);
+            }
+#endif
+        }
+    }
+
+    /// The backend in use, after any fallback
+    SinkBackend backend() const noexcept { return backend_; }
+
+    /// Bytes handed back to the ring so far
+    std::uint64_t written() const noexcept { return written_; }
+
+    /// writev() or io_uring_enter() calls made so far
+    std::uint64_t syscalls() const noexcept { return syscalls_; }
+
+private:
+    /// One write in flight: `length` bytes starting `start` bytes past the pop cursor of
+    /// the first unreleased write; `done` of them are written
+    struct Write {
+        std::size_t start;
+        std::size_t length;
+        std::size_t done;
+        iovec iov[2];
+    };
+
+    /// Up to two iovecs over the readable bytes `offset` bytes past the pop cursor
+    unsigned gather(std::size_t offset, iovec (&iov)[2]) {
+        unsigned count = 0;
+        std::size_t total = 0;
+        while (count < 2 and total < maxBatch_) {
+            auto span = ring_.peek(maxBatch_ - total, offset + total);
+            if (span.empty()) {
+                break;
+            }
+            iov[count++] = {const_cast<std::byte*>(span.data()), span.size()};
+            total += span.size();
+        }
+        return count;
+    }
+
+    /// Bytes of the ring held by writes in flight
+    std::size_t busy() const noexcept { return submitted_; }
+
+    std::size_t pollWritev() {
+        iovec iov[2];
+        auto count = gather(0, iov);
+        if (count == 0) {
+            return 0;
+        }
+        ++syscalls_;
+        auto n = ::writev(fd_, iov, static_cast<int>(count));
+        if (n == -1) {
+            if (errno == EINTR or errno == EAGAIN) {
+                return 0;
+            }
+            throw std::system_error(errno, std::system_category(), "writev");
+        }
+        ring_.consume(static_cast<std::size_t>(n));
+        written_ += static_cast<std::size_t>(n);
+        return static_cast<std::size_t>(n);
+    }
+
+#if QUEUE_HAS_IO_URING
+    void submit(Write& write) {
+        // Skip what a short write already covered; at most the first iovec
+        std::size_t skip = write.done;
+        iovec iov[2];
+        unsigned count = 0;
+        for (auto& part : write.iov) {
+            if (part.iov_len == 0) {
+                continue;
+            }
+            if (skip >= part.iov_len) {
+                skip -= part.iov_len;
+                continue;
+            }
+            iov[count++] = {static_cast<std::byte*>(part.iov_base) + skip, part.iov_len - skip};
+            skip = 0;
+        }
+        std::copy(iov, iov + count, write.iov);
+        std::fill(write.iov + count, write.iov + 2, iovec{});
+        write.length -= write.done;
+        write.start += write.done;
+        write.done = 0;
+        auto offset = offset_ == -1 ? std::int64_t{-1} : std::int64_t(offset_) + std::int64_t(write.start);
+        uring_->prepareWritev(fd_, write.iov, count, offset, static_cast<std::uint64_t>(&write - writes_.data()));
+    }
+
+    void reap() {
+        uring_->reap([&](std::uint64_t index, int result) {
+            auto& write = writes_[index];
+            if (result < 0) {
+                if (result != -EINTR and result != -EAGAIN) {
+                    error_ = -result;
+                }
+                resubmit_.push_back(index);
+            } else if ((write.done += static_cast<std::size_t>(result)) < write.length) {
+                resubmit_.push_back(index);
+            } else {
+                --inFlight_;
+            }
+        });
+    }
+
+    /// Writes complete in any order on a file: hands back the completed prefix only
+    std::size_t release() {
+        std::size_t released = 0;
+        while (first_ != next_ and writes_[first_ % depth_].length == writes_[first_ % depth_].done) {
+            auto& write = writes_[first_ % depth_];
+            auto length = write.start + write.length;
+            ring_.consume(length);
+            for (auto i = first_ + 1; i != next_; ++i) {
+                writes_[i % depth_].start -= length;
+            }
+            if (offset_ != -1) {
+                offset_ += static_cast<off_t>(length);
+            }
+            submitted_ -= length;
+            released += length;
+            ++first_;
+        }
+        written_ += released;
+        return released;
+    }
+
+    std::size_t pollUring(bool wait) {
+        if (wait) {
+            ++syscalls_;
+            uring_->enter(true);
+        }
+        reap();
+        if (error_ != 0) {
+            throw std::system_error(error_, std::system_category(), "io_uring writev");
+        }
+        for (auto index : resubmit_) {
+            submit(writes_[index]);
+        }
+        bool queued = not resubmit_.empty();
+        resubmit_.clear();
+
+        auto released = release();
+
+        while (next_ - first_ < depth_) {
+            auto& write = writes_[next_ % depth_];
+            write = {submitted_, 0, 0, {}};
+            auto count = gather(submitted_, write.iov);
+            if (count == 0) {
+                break;
+            }
+            for (unsigned i = 0; i < count; ++i) {
+                write.length += write.iov[i].iov_len;
+            }
+            submitted_ += write.length;
+            submit(write);
+            ++inFlight_;
+            ++next_;
+            queued = true;
+        }
+        if (queued) {
+            ++syscalls_;
+            uring_->enter(false);
+        }
+        return released;
+    }
+#endif
+
+    Ring& ring_;
+    const int fd_;
+    const std::size_t maxBatch_;
+    SinkBackend backend_;
+    std::uint64_t written_{0};
+    std::uint64_t syscalls_{0};
+    /// Bytes past the pop cursor covered by writes in flight
+    std::size_t submitted_{0};
+#if QUEUE_HAS_IO_URING
+    std::unique_ptr<IoUring> uring_;
+    unsigned depth_{1};
+    /// File offset of the pop cursor, or -1 to write at the file position
+    off_t offset_{-1};
+    std::vector<Write> writes_;
+    std::vector<std::uint64_t> resubmit_;
+    std::uint64_t first_{0};
+    std::uint64_t next_{0};
+    unsigned inFlight_{0};
+    int error_{0};
+#endif
+};
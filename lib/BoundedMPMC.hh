@@ -0,0 +1,120 @@
+#pragma once
+
+#include "cache_line.hh"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+/// Bounded multi producer multi consumer FIFO (Vyukov): every slot carries a sequence number
+/// telling producers and consumers whose turn it is, so each side only contends on its own
+/// cursor. Also serves as the shared ring baseline for MPSC use.
+template<typename T, const int N = 1 << 17>
+class BoundedMPMC
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static_assert(N > 1 and (N & (N - 1)) == 0, "capacity must be a power of two");
+
+    BoundedMPMC()
+        : cells_{new Cell[N]}
+    {
+        for (size_type i = 0; i < N; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMPMC(BoundedMPMC const&) = delete;
+    BoundedMPMC& operator=(BoundedMPMC const&) = delete;
+
+    /// Returns the number of elements in the fifo; exact only while no thread operates on it
+    auto size() const noexcept {
+        auto pushCursor = pushCursor_.load(std::memory_order_relaxed);
+        auto popCursor = popCursor_.load(std::memory_order_relaxed);
+
+        return pushCursor - popCursor;
+    }
+
+    /// Returns whether the container has no elements
+    bool empty() const noexcept { return size() == 0; }
+
+    /// Returns whether the container has capacity() elements
+    bool full() const noexcept { return size() == capacity(); }
+
+    /// Returns the number of elements that can be held in the fifo
+    size_type capacity() const noexcept { return N; }
+
+    /// Push one object onto the fifo; safe to call from any number of threads.
+    /// @return `true` if the operation is successful; `false` if fifo is full.
+    bool push(const T& value) {
+        auto pushCursor = pushCursor_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pushCursor & bit_mask];
+            auto sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pushCursor);
+            if (diff == 0) {
+                if (pushCursor_.compare_exchange_weak(pushCursor, pushCursor + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pushCursor = pushCursor_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pushCursor + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Pop one object from the fifo; safe to call from any number of threads.
+    /// @return `true` if the pop operation is successful; `false` if fifo is empty.
+    bool pop(T& value) {
+        auto popCursor = popCursor_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[popCursor & bit_mask];
+            auto sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(popCursor + 1);
+            if (diff == 0) {
+                if (popCursor_.compare_exchange_weak(popCursor, popCursor + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                popCursor = popCursor_.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->value;
+        cell->sequence.store(popCursor + N, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr size_type bit_mask = N - 1;
+
+    struct Cell {
+        std::atomic<size_type> sequence;
+        T value;
+    };
+
+    using CursorType = std::atomic<size_type>;
+    static_assert(CursorType::is_always_lock_free);
+
+    std::unique_ptr<Cell[]> cells_;
+
+    /// Claimed by producers with a CAS
+    alignas(CACHE_LINE_SIZE) CursorType pushCursor_{0};
+
+    /// Claimed by consumers with a CAS
+    alignas(CACHE_LINE_SIZE) CursorType popCursor_{0};
+
+    char padding_[CACHE_LINE_SIZE - sizeof(CursorType)];
+};
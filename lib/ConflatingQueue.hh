@@ -0,0 +1,115 @@
+#pragma once
+
+#include "SPSCLocal.hh"
+#include "Seqlock.hh"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+/// Single producer, single consumer conflating queue: keeps only the latest value per key.
+/// Values live in a fixed table indexed by key, each slot under a seqlock whose version
+/// counts the updates. The first update of a key since the consumer last took it enqueues
+/// the key on a dirty-key ring; later updates overwrite the slot in place. Every key is at
+/// most once in the ring, so a ring of `DirtyN` >= keys never fills and push never fails.
+template<typename T, const int DirtyN = 1 << 12>
+class ConflatingQueue
+{
+public:
+    using value_type = T;
+    using key_type = std::uint32_t;
+    using size_type = std::size_t;
+
+    /// @throw std::invalid_argument if `keys` exceeds the dirty ring capacity.
+    explicit ConflatingQueue(size_type keys)
+        : keys_{checkedKeys(keys)}
+        , slots_{new Slot[keys_]}
+    {}
+
+    ConflatingQueue(ConflatingQueue const&) = delete;
+    ConflatingQueue& operator=(ConflatingQueue const&) = delete;
+
+    /// Returns the number of keys in the table
+    size_type keys() const noexcept { return keys_; }
+
+    /// Returns the number of keys with an update not yet taken by the consumer
+    auto size() const noexcept { return dirty_.size(); }
+
+    /// Returns whether no key has a pending update
+    bool empty() const noexcept { return dirty_.empty(); }
+
+    /// Publish the latest value of `key`, replacing any pending one; producer only
+    void push(key_type key, const T& value) {
+        assert(key < keys_);
+        auto& slot = slots_[key];
+        slot.value.store(value);
+        if (slot.pending.exchange(true, std::memory_order_acq_rel)) {
+            ++conflated_;
+            return;
+        }
+        auto pushed = dirty_.push(key);
+        assert(pushed);
+        (void)pushed;
+    }
+
+    /// Take the latest value of the next changed key; consumer only.
+    /// @return `true` if the pop operation is successful; `false` if no key changed.
+    bool pop(key_type& key, T& value) {
+        if (not dirty_.pop(key)) {
+            return false;
+        }
+        auto& slot = slots_[key];
+        // Clear before reading, so an update racing the read enqueues the key again. Both sides
+        // exchange the flag: whichever update the exchange orders first is seen by the other.
+        slot.pending.exchange(false, std::memory_order_acq_rel);
+        slot.value.load(value);
+        return true;
+    }
+
+    /// Hands every key changed since the last drain to `f(key, value)`; consumer only.
+    /// @return the number of keys delivered.
+    template<typename F>
+    size_type drain(F&& f) {
+        size_type delivered = 0;
+        key_type key;
+        T value;
+        for (auto n = dirty_.size(); n > 0 and pop(key, value); --n) {
+            f(key, value);
+            ++delivered;
+        }
+        return delivered;
+    }
+
+    /// Number of updates of `key` published so far
+    std::uint64_t version(key_type key) const noexcept { return slots_[key].value.version(); }
+
+    /// Number of pushes that replaced a value the consumer had not taken yet; producer only
+    std::uint64_t conflated() const noexcept { return conflated_; }
+
+private:
+    static size_type checkedKeys(size_type keys) {
+        if (keys > DirtyN) {
+            throw std::invalid_argument("ConflatingQueue: more keys than dirty ring slots");
+        }
+        return keys;
+    }
+
+    struct Slot {
+        Seqlock<T> value;
+        std::atomic<bool> pending{false};
+    };
+
+    size_type keys_;
+    std::unique_ptr<Slot[]> slots_;
+
+    /// Keys with a pending update, in the order they first changed
+    SPSCLocal<key_type, DirtyN> dirty_;
+
+    /// Producer local
+    alignas(CACHE_LINE_SIZE) std::uint64_t conflated_{0};
+
+    char padding_[CACHE_LINE_SIZE - sizeof(std::uint64_t)];
+};
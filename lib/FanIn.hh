@@ -0,0 +1,193 @@
+#pragma once
+
+#include "SPSCLocal.hh"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+enum class FanInMode
+{
+    /// One element from each non-empty queue per visit, continuing after the last queue served
+    RoundRobin,
+    /// Queues visited in index order (0 first), each yielding up to its weight per poll
+    WeightedPriority,
+    /// Up to batch() elements from each non-empty queue per visit, round-robin between queues
+    DrainBatch,
+};
+
+/// One consumer polling many SPSC queues, one per producer thread.
+/// Producers flag their queue in a shared dirty bitmap (a single cache line for up to 512
+/// queues) after pushing, and only when the flag is not already set. The consumer swaps the
+/// bitmap out instead of touching the cursors of every empty queue. The bitmap is a hint:
+/// a producer may skip raising a flag the consumer is clearing at that moment, so the
+/// consumer also sweeps all queues every `sweepInterval` polls, busy or not.
+template<typename Queue = SPSCLocal<std::int64_t, 1 << 12>>
+class FanIn
+{
+public:
+    using queue_type = Queue;
+    using value_type = typename Queue::value_type;
+    using size_type = std::size_t;
+
+    static constexpr size_type maxQueues = 512;
+    static constexpr size_type sweepInterval = 64;
+
+    explicit FanIn(size_type queues, FanInMode mode = FanInMode::RoundRobin)
+        : count_{checkedCount(queues)}
+        , mode_{mode}
+        , queues_{new Queue[count_]}
+        , weights_(count_, 1)
+    {}
+
+    FanIn(FanIn const&) = delete;
+    FanIn& operator=(FanIn const&) = delete;
+
+    /// Returns the number of producer queues
+    size_type queues() const noexcept { return count_; }
+
+    /// Direct access to a producer queue, e.g. for capacity or size queries
+    Queue& queue(size_type index) noexcept { return queues_[index]; }
+
+    /// Push one object onto queue `index`; must only be called by that queue's producer.
+    /// @return `true` if the operation is successful; `false` if the queue is full.
+    bool push(size_type index, const value_type& value) {
+        assert(index < count_);
+        if (not queues_[index].push(value)) {
+            return false;
+        }
+        auto& word = dirty_[index / bitsPerWord];
+        auto bit = std::uint64_t{1} << (index % bitsPerWord);
+        // Leave the line shared while the flag is already up
+        if (not (word.load(std::memory_order_relaxed) & bit)) {
+            word.fetch_or(bit, std::memory_order_release);
+        }
+        return true;
+    }
+
+    /// WeightedPriority: maximum elements taken from queue `index` per poll (consumer only)
+    void setWeight(size_type index, unsigned weight) noexcept { weights_[index] = weight; }
+
+    /// DrainBatch: maximum elements taken from one queue per visit (consumer only)
+    void setBatch(size_type batch) noexcept { batch_ = batch; }
+    size_type batch() const noexcept { return batch_; }
+
+    /// Deliver available elements as `f(queueIndex, value)` according to the mode.
+    /// Must only be called by the consumer thread.
+    /// @return the number of elements delivered.
+    template<typename F>
+    size_type poll(F&& f) {
+        collect();
+        size_type delivered = 0;
+        switch (mode_) {
+        case FanInMode::RoundRobin:
+            delivered = visit(next_, [](size_type) { return size_type{1}; }, f);
+            break;
+        case FanInMode::WeightedPriority:
+            delivered = visit(0, [this](size_type index) { return size_type{weights_[index]}; }, f);
+            break;
+        case FanInMode::DrainBatch:
+            delivered = visit(next_, [this](size_type) { return batch_; }, f);
+            break;
+        }
+        // Regardless of deliveries: a lost flag would otherwise wait for an idle poll
+        if (++polls_ >= sweepInterval) {
+            sweep();
+        }
+        return delivered;
+    }
+
+private:
+    static constexpr size_type bitsPerWord = 64;
+    static constexpr size_type words = maxQueues / bitsPerWord;
+
+    static size_type checkedCount(size_type queues) {
+        if (queues == 0 or queues > maxQueues) {
+            throw std::invalid_argument("FanIn supports 1 to 512 queues");
+        }
+        return queues;
+    }
+
+    size_type usedWords() const noexcept { return (count_ + bitsPerWord - 1) / bitsPerWord; }
+
+    /// Merges the flags raised by producers into the consumer-local pending set
+    void collect() noexcept {
+        for (size_type w = 0; w < usedWords(); ++w) {
+            if (dirty_[w].load(std::memory_order_relaxed)) {
+                pending_[w] |= dirty_[w].exchange(0, std::memory_order_acquire);
+            }
+        }
+    }
+
+    /// Flags every non-empty queue, catching any whose producer's flag was lost in a race
+    void sweep() noexcept {
+        polls_ = 0;
+        for (size_type index = 0; index < count_; ++index) {
+            if (not queues_[index].empty()) {
+                pending_[index / bitsPerWord] |= std::uint64_t{1} << (index % bitsPerWord);
+            }
+        }
+    }
+
+    /// Visits pending queues in index order starting at `start`, wrapping around once.
+    /// A queue stays pending while it still had elements when its budget ran out.
+    template<typename Budget, typename F>
+    size_type visit(size_type start, Budget budget, F& f) {
+        size_type delivered = 0;
+        const auto used = usedWords();
+        const auto startWord = start / bitsPerWord;
+        const auto startBits = ~std::uint64_t{0} << (start % bitsPerWord);
+
+        for (size_type n = 0; n <= used; ++n) {
+            auto w = (startWord + n) % used;
+            auto bits = pending_[w];
+            if (n == 0) {
+                bits &= startBits;
+            } else if (n == used) {
+                bits &= ~startBits;
+            }
+            while (bits) {
+                auto index = w * bitsPerWord + std::countr_zero(bits);
+                bits &= bits - 1;
+
+                auto& queue = queues_[index];
+                auto limit = budget(index);
+                size_type taken = 0;
+                value_type value;
+                while (taken < limit and queue.pop(value)) {
+                    f(index, value);
+                    ++taken;
+                }
+                if (taken < limit) {
+                    pending_[w] &= ~(std::uint64_t{1} << (index % bitsPerWord));
+                }
+                if (taken) {
+                    delivered += taken;
+                    next_ = index + 1 == count_ ? 0 : index + 1;
+                }
+            }
+        }
+        return delivered;
+    }
+
+    // Consumer-local state
+    size_type count_;
+    FanInMode mode_;
+    std::unique_ptr<Queue[]> queues_;
+    std::vector<unsigned> weights_;
+    size_type batch_{64};
+    size_type next_{0};
+    size_type polls_{0};
+    std::array<std::uint64_t, words> pending_{};
+
+    /// Raised by producers after a push, swapped out by the consumer
+    alignas(CACHE_LINE_SIZE) std::array<std::atomic<std::uint64_t>, words> dirty_{};
+
+    char padding_[CACHE_LINE_SIZE];
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "cache_line.hh"
+
+#include <atomic>
+#include <concepts>
+
+/// Link embedded in objects that travel through an IntrusiveMPSC; derive from it. An
+/// object can be in at most one queue at a time.
+struct MPSCHook {
+    std::atomic<MPSCHook*> next{nullptr};
+};
+
+/// Unbounded intrusive multi producer single consumer FIFO (Vyukov): the queue links the
+/// objects it is handed through their MPSCHook, so nothing is copied or allocated and a
+/// push cannot fail. Producers swap themselves in as the new head with one exchange and
+/// then link the previous head to it (wait-free); the consumer follows the links from the
+/// tail. A stub node keeps the list non-empty. The caller owns the objects and must keep
+/// them alive until they are popped. Per-producer order is kept.
+template<typename T>
+requires std::derived_from<T, MPSCHook>
+class IntrusiveMPSC
+{
+public:
+    using value_type = T;
+
+    IntrusiveMPSC() noexcept = default;
+
+    IntrusiveMPSC(IntrusiveMPSC const&) = delete;
+    IntrusiveMPSC& operator=(IntrusiveMPSC const&) = delete;
+
+    /// Links `item` in at the head; any thread, never blocks or fails
+    void push(T* item) noexcept { link(item); }
+
+    /// Unlinks the oldest object; consumer only.
+    /// @return the object, or nullptr if the queue is empty or a producer has swapped in
+    /// its object but not linked it yet (it shows up on a later pop).
+    T* pop() noexcept {
+        MPSCHook* tail = tail_;
+        MPSCHook* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (not next) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        if (tail != head_.load(std::memory_order_acquire)) {
+            // A producer is between its exchange and its link
+            return nullptr;
+        }
+        // `tail` is the last object: put the stub behind it so it can be handed out
+        link(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        return nullptr;
+    }
+
+    /// Whether there is nothing to pop; consumer only, and approximate while producers push
+    bool empty() const noexcept {
+        return tail_ == &stub_ and stub_.next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    void link(MPSCHook* node) noexcept {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        auto* previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /// Swapped by every producer
+    alignas(CACHE_LINE_SIZE) std::atomic<MPSCHook*> head_{&stub_};
+
+    /// Consumer only; the stub's link is written by the producer that follows it
+    alignas(CACHE_LINE_SIZE) MPSCHook* tail_{&stub_};
+    MPSCHook stub_;
+
+    char padding_[CACHE_LINE_SIZE - sizeof(MPSCHook*) - sizeof(MPSCHook)];
+};
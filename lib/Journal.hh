@@ -0,0 +1,469 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// When the producer forces written records to storage with msync
+enum class SyncPolicy
+{
+    /// Never; the page cache writes back on its own schedule (survives a process crash only)
+    None,
+    /// From append() once `syncInterval` elapsed since the last sync
+    Periodic,
+    /// On every endBatch()
+    PerBatch,
+};
+
+struct JournalConfig
+{
+    /// Bytes per segment file, header included; a multiple of the page size
+    std::size_t segmentSize{std::size_t{64} << 20};
+    SyncPolicy sync{SyncPolicy::None};
+    std::chrono::nanoseconds syncInterval{std::chrono::milliseconds{10}};
+};
+
+/// Position of a tailer: segment index and byte offset inside that segment
+struct JournalPosition
+{
+    std::uint64_t segment{0};
+    std::uint64_t offset{0};
+};
+
+namespace journal_detail {
+
+/// Segment layout: a header line (magic, index, sealed flag), the committed write offset on
+/// its own cache line, then records. A record is a 4 byte length, 4 reserved bytes and the
+/// payload padded to 8 bytes. A record whose length is `rollMarker` tells the tailer to
+/// continue in the next segment.
+inline constexpr std::uint64_t magic = 0x4353505346524e4a;
+inline constexpr std::size_t indexOffset = 8;
+inline constexpr std::size_t sealedOffset = 16;
+inline constexpr std::size_t cursorOffset = 64;
+inline constexpr std::size_t dataOffset = 128;
+inline constexpr std::size_t recordHeader = 8;
+inline constexpr std::uint32_t rollMarker = 0xffffffff;
+
+inline constexpr std::size_t align8(std::size_t n) noexcept { return (n + 7) & ~std::size_t{7}; }
+
+inline std::filesystem::path segmentPath(const std::filesystem::path& directory, std::uint64_t index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llu.seg", static_cast<unsigned long long>(index));
+    return directory / name;
+}
+
+/// Indices of the first and last segment present in `directory`, if any
+inline std::optional<std::pair<std::uint64_t, std::uint64_t>> segmentRange(const std::filesystem::path& directory) {
+    std::optional<std::pair<std::uint64_t, std::uint64_t>> range;
+    if (not std::filesystem::is_directory(directory)) {
+        return range;
+    }
+    for (const auto& entry : std::filesystem::directory_iterator{directory}) {
+        const auto& path = entry.path();
+        if (path.extension() != ".seg" or path.stem().string().size() != 16) {
+            continue;
+        }
+        auto index = static_cast<std::uint64_t>(std::stoull(path.stem().string()));
+        if (not range) {
+            range.emplace(index, index);
+        }
+        range->first = std::min(range->first, index);
+        range->second = std::max(range->second, index);
+    }
+    return range;
+}
+
+/// One memory-mapped segment file
+class Segment
+{
+public:
+    /// Creates segment `index` under a temporary name and renames it into place once its
+    /// header is written, so a tailer never maps a half-initialised file.
+    /// @throw std::system_error on any failing system call.
+    static Segment create(const std::filesystem::path& directory, std::uint64_t index, std::size_t size) {
+        auto path = segmentPath(directory, index);
+        auto temporary = path;
+        temporary += ".tmp";
+        int fd = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1) {
+            throw std::system_error(errno, std::system_category(), "open " + temporary.string());
+        }
+        if (::ftruncate(fd, static_cast<off_t>(size)) == -1) {
+            auto error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::system_category(), "ftruncate");
+        }
+        Segment segment{fd, size, true};
+        std::memcpy(segment.data_, &magic, sizeof(magic));
+        std::memcpy(segment.data_ + indexOffset, &index, sizeof(index));
+        segment.committed().store(dataOffset, std::memory_order_release);
+        if (::rename(temporary.c_str(), path.c_str()) == -1) {
+            throw std::system_error(errno, std::system_category(), "rename " + path.string());
+        }
+        return segment;
+    }
+
+    /// Maps an existing segment.
+    /// @return the segment, or nothing if it does not exist (yet).
+    /// @throw std::system_error on any other failure.
+    static std::optional<Segment> open(const std::filesystem::path& directory, std::uint64_t index, bool writable) {
+        auto path = segmentPath(directory, index);
+        int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd == -1) {
+            if (errno == ENOENT) {
+                return std::nullopt;
+            }
+            throw std::system_error(errno, std::system_category(), "open " + path.string());
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == -1) {
+            auto error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::system_category(), "fstat");
+        }
+        Segment segment{fd, static_cast<std::size_t>(info.st_size), writable};
+        std::uint64_t header;
+        std::memcpy(&header, segment.data_, sizeof(header));
+        if (header != magic) {
+            throw std::runtime_error("not a journal segment: " + path.string());
+        }
+        return segment;
+    }
+
+    Segment(Segment&& other) noexcept
+        : fd_{std::exchange(other.fd_, -1)}
+        , size_{other.size_}
+        , data_{std::exchange(other.data_, nullptr)}
+    {}
+
+    Segment& operator=(Segment&& other) noexcept {
+        if (this != &other) {
+            release();
+            fd_ = std::exchange(other.fd_, -1);
+            size_ = other.size_;
+            data_ = std::exchange(other.data_, nullptr);
+        }
+        return *this;
+    }
+
+    ~Segment() { release(); }
+
+    std::byte* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+    /// Whether the producer ended this segment with a roll marker
+    bool sealed() const noexcept {
+        std::uint64_t flag;
+        std::memcpy(&flag, data_ + sealedOffset, sizeof(flag));
+        return flag != 0;
+    }
+
+    /// Offset one past the last published record; written by the producer, read by tailers
+    std::atomic_ref<std::uint64_t> committed() const noexcept {
+        return std::atomic_ref<std::uint64_t>{*reinterpret_cast<std::uint64_t*>(data_ + cursorOffset)};
+    }
+
+    /// Synchronously writes back the pages covering [from, to)
+    void sync(std::size_t from, std::size_t to) const {
+        static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        from &= ~(page - 1);
+        if (to > from and ::msync(data_ + from, to - from, MS_SYNC) == -1) {
+            throw std::system_error(errno, std::system_category(), "msync");
+        }
+    }
+
+private:
+    Segment(int fd, std::size_t size, bool writable)
+        : fd_{fd}
+        , size_{size}
+    {
+        auto protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        auto* addr = ::mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            auto error = errno;
+            ::close(fd);
+            fd_ = -1;
+            throw std::system_error(error, std::system_category(), "mmap");
+        }
+        data_ = static_cast<std::byte*>(addr);
+    }
+
+    void release() noexcept {
+        if (data_) {
+            ::munmap(data_, size_);
+        }
+        if (fd_ != -1) {
+            ::close(fd_);
+        }
+    }
+
+    int fd_;
+    std::size_t size_;
+    std::byte* data_{nullptr};
+};
+
+}  // namespace journal_detail
+
+/// Producer side of a file-backed SPSC queue. Records are appended to rolling memory-mapped
+/// segment files in `directory`; each segment publishes its committed offset with the same
+/// release/acquire cursor protocol as SPSCLocal, so a JournalTailer in this or another process
+/// reads records in place. Opening an existing journal resumes appending after its last
+/// committed record. Old segments are never deleted.
+class Journal
+{
+public:
+    /// @throw std::invalid_argument if `config.segmentSize` cannot hold a record.
+    /// @throw std::system_error if the directory or a segment cannot be created or mapped.
+    explicit Journal(std::filesystem::path directory, JournalConfig config = {})
+        : directory_{std::move(directory)}
+        , config_{checkedConfig(config)}
+        , segment_{open()}
+        , pushCursor_{segment_.committed().load(std::memory_order_acquire)}
+        , syncedTo_{pushCursor_}
+        , lastSync_{std::chrono::steady_clock::now()}
+    {}
+
+    Journal(Journal const&) = delete;
+    Journal& operator=(Journal const&) = delete;
+
+    /// Largest payload a segment can hold
+    std::size_t maxRecord() const noexcept {
+        return config_.segmentSize - journal_detail::dataOffset - 2 * journal_detail::recordHeader;
+    }
+
+    /// Append one record, rolling to a new segment when the current one is full.
+    /// @throw std::invalid_argument if `size` exceeds maxRecord().
+    void append(const void* data, std::uint32_t size) {
+        using namespace journal_detail;
+        if (size > maxRecord()) {
+            throw std::invalid_argument("Journal: record larger than a segment");
+        }
+        auto length = recordHeader + align8(size);
+        // Always leave room for a roll marker
+        if (pushCursor_ + length + recordHeader > segment_.size()) {
+            roll();
+        }
+        auto* record = segment_.data() + pushCursor_;
+        std::uint64_t header = size;
+        std::memcpy(record, &header, sizeof(header));
+        std::memcpy(record + recordHeader, data, size);
+        pushCursor_ += length;
+        segment_.committed().store(pushCursor_, std::memory_order_release);
+
+        if (config_.sync == SyncPolicy::Periodic and std::chrono::steady_clock::now() - lastSync_ >= config_.syncInterval) {
+            flush();
+        }
+    }
+
+    template<typename T>
+    void append(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        append(&value, sizeof(T));
+    }
+
+    /// Marks the end of a batch of appends; syncs under SyncPolicy::PerBatch
+    void endBatch() {
+        if (config_.sync == SyncPolicy::PerBatch) {
+            flush();
+        }
+    }
+
+    /// Writes back every record appended since the last sync, whatever the policy
+    void flush() {
+        segment_.sync(syncedTo_, pushCursor_);
+        // The header page holds the committed offset
+        segment_.sync(0, journal_detail::dataOffset);
+        syncedTo_ = pushCursor_;
+        lastSync_ = std::chrono::steady_clock::now();
+    }
+
+    /// Where the next record will be written
+    JournalPosition position() const noexcept { return {index_, pushCursor_}; }
+
+private:
+    static JournalConfig checkedConfig(const JournalConfig& config) {
+        using namespace journal_detail;
+        // Header, one 8-byte record and the roll marker
+        if (config.segmentSize < dataOffset + 2 * recordHeader + 8) {
+            throw std::invalid_argument("Journal: segment size too small for a record");
+        }
+        return config;
+    }
+
+    journal_detail::Segment open() {
+        std::filesystem::create_directories(directory_);
+        if (auto range = journal_detail::segmentRange(directory_)) {
+            index_ = range->second;
+            // Empty if the segment was removed since the directory was listed: start it afresh
+            if (auto last = journal_detail::Segment::open(directory_, index_, true)) {
+                if (not last->sealed()) {
+                    return std::move(*last);
+                }
+                // Stopped between sealing a segment and creating the next one
+                ++index_;
+            }
+        }
+        return journal_detail::Segment::create(directory_, index_, config_.segmentSize);
+    }
+
+    void roll() {
+        using namespace journal_detail;
+        // A tailer reaching the marker before the next segment exists just reports no record
+        std::uint64_t header = rollMarker;
+        std::uint64_t sealed = 1;
+        std::memcpy(segment_.data() + pushCursor_, &header, sizeof(header));
+        std::memcpy(segment_.data() + sealedOffset, &sealed, sizeof(sealed));
+        pushCursor_ += recordHeader;
+        segment_.committed().store(pushCursor_, std::memory_order_release);
+        if (config_.sync != SyncPolicy::None) {
+            flush();
+        }
+        segment_ = Segment::create(directory_, index_ + 1, config_.segmentSize);
+        ++index_;
+        pushCursor_ = dataOffset;
+        syncedTo_ = dataOffset;
+    }
+
+    std::filesystem::path directory_;
+    JournalConfig config_;
+    std::uint64_t index_{0};
+    journal_detail::Segment segment_;
+    std::uint64_t pushCursor_;
+    std::uint64_t syncedTo_;
+    std::chrono::steady_clock::time_point lastSync_;
+};
+
+/// Consumer side of a Journal: reads records in place, following roll markers across
+/// segments. A named tailer persists its position with checkpoint() in `<name>.ckpt` inside
+/// the journal directory and resumes from it when reopened.
+class JournalTailer
+{
+public:
+    /// Starts at the checkpoint of `name` if there is one, otherwise at the oldest segment.
+    /// @throw std::system_error if the checkpoint file cannot be opened or read.
+    explicit JournalTailer(std::filesystem::path directory, const std::string& name = {})
+        : directory_{std::move(directory)}
+    {
+        if (auto range = journal_detail::segmentRange(directory_)) {
+            position_.segment = range->first;
+        }
+        position_.offset = journal_detail::dataOffset;
+        if (not name.empty()) {
+            auto path = directory_ / (name + ".ckpt");
+            checkpointFd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (checkpointFd_ == -1) {
+                throw std::system_error(errno, std::system_category(), "open " + path.string());
+            }
+            JournalPosition saved;
+            auto n = ::pread(checkpointFd_, &saved, sizeof(saved), 0);
+            if (n == -1) {
+                throw std::system_error(errno, std::system_category(), "pread");
+            }
+            if (n == sizeof(saved)) {
+                position_ = saved;
+            }
+        }
+        pushLocal_ = position_.offset;
+    }
+
+    JournalTailer(JournalTailer const&) = delete;
+    JournalTailer& operator=(JournalTailer const&) = delete;
+
+    ~JournalTailer() {
+        if (checkpointFd_ != -1) {
+            ::close(checkpointFd_);
+        }
+    }
+
+    /// Hands the next record to `f(const std::byte* data, std::uint32_t size)`, in place;
+    /// the pointer is valid during the call only.
+    /// @return `true` if a record was read; `false` if the tailer is caught up.
+    template<typename F>
+    requires std::is_invocable_v<F&, const std::byte*, std::uint32_t>
+    bool read(F&& f) {
+        using namespace journal_detail;
+        while (true) {
+            if (not segment_ and not (segment_ = Segment::open(directory_, position_.segment, false))) {
+                return false;
+            }
+            if (position_.offset == pushLocal_) {
+                pushLocal_ = segment_->committed().load(std::memory_order_acquire);
+                if (position_.offset == pushLocal_) {
+                    return false;
+                }
+            }
+            auto* record = segment_->data() + position_.offset;
+            std::uint64_t header;
+            std::memcpy(&header, record, sizeof(header));
+            auto size = static_cast<std::uint32_t>(header);
+            if (size == rollMarker) {
+                segment_.reset();
+                ++position_.segment;
+                position_.offset = dataOffset;
+                pushLocal_ = dataOffset;
+                continue;
+            }
+            f(record + recordHeader, size);
+            position_.offset += recordHeader + align8(size);
+            return true;
+        }
+    }
+
+    /// Copies the next record into `value`; the record must have been appended as a T.
+    /// @return `true` if a record was read; `false` if the tailer is caught up.
+    template<typename T>
+    requires (std::is_trivially_copyable_v<T> and not std::is_invocable_v<T&, const std::byte*, std::uint32_t>)
+    bool read(T& value) {
+        return read([&value](const std::byte* data, std::uint32_t size) {
+            assert(size == sizeof(T) and "record size differs from the type read");
+            std::memcpy(&value, data, std::min<std::size_t>(size, sizeof(T)));
+        });
+    }
+
+    /// Reads every record published so far.
+    /// @return the number of records handed to `f`.
+    template<typename F>
+    std::size_t replay(F&& f) {
+        std::size_t count = 0;
+        while (read(f)) {
+            ++count;
+        }
+        return count;
+    }
+
+    /// Persists the current position for a restarted tailer of the same name
+    void checkpoint() {
+        if (checkpointFd_ != -1 and ::pwrite(checkpointFd_, &position_, sizeof(position_), 0) == -1) {
+            throw std::system_error(errno, std::system_category(), "pwrite");
+        }
+    }
+
+    /// Position of the next record to be read
+    JournalPosition position() const noexcept { return position_; }
+
+private:
+    std::filesystem::path directory_;
+    std::optional<journal_detail::Segment> segment_;
+    JournalPosition position_;
+    /// Cached committed offset of the current segment
+    std::uint64_t pushLocal_{0};
+    int checkpointFd_{-1};
+};
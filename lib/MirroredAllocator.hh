@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/// Allocator for ring storage whose pages are mapped twice, back to back: element
+/// `i + n` aliases element `i` for every i < n, so a window of up to n elements starting
+/// at any slot is contiguous in virtual memory. The pages come from an anonymous memfd.
+/// n * sizeof(T) must be a multiple of the page size, otherwise allocate() throws
+/// std::invalid_argument; failing system calls throw std::system_error.
+template<typename T>
+class MirroredAllocator
+{
+public:
+    using value_type = T;
+
+    /// Queues check this to hand out wrap-free spans
+    static constexpr bool mirrored = true;
+
+    MirroredAllocator() noexcept = default;
+
+    template<typename U>
+    MirroredAllocator(MirroredAllocator<U> const&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        const auto bytes = n * sizeof(T);
+        const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        if (bytes == 0 or bytes % page != 0) {
+            throw std::invalid_argument("mirrored ring of " + std::to_string(bytes) +
+                                        " bytes is not a multiple of the page size");
+        }
+
+        int fd = ::memfd_create("mirrored-ring", MFD_CLOEXEC);
+        if (fd == -1) {
+            throw std::system_error(errno, std::system_category(), "memfd_create");
+        }
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) == -1) {
+            auto error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::system_category(), "ftruncate");
+        }
+
+        // Reserve both halves first so nothing else can land in the second one
+        auto* base = static_cast<std::byte*>(::mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (base == MAP_FAILED) {
+            auto error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::system_category(), "mmap");
+        }
+        for (auto* half : {base, base + bytes}) {
+            if (::mmap(half, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                auto error = errno;
+                ::munmap(base, 2 * bytes);
+                ::close(fd);
+                throw std::system_error(error, std::system_category(), "mmap");
+            }
+        }
+        // The mappings keep the memory alive
+        ::close(fd);
+        return reinterpret_cast<T*>(base);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        ::munmap(p, 2 * n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(MirroredAllocator<U> const&) const noexcept { return true; }
+};
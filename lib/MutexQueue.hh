@@ -0,0 +1,102 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/// Baseline for the lock-free queues: a std::deque behind a std::mutex, bounded to
+/// `capacity` elements like they are. push()/pop() never wait; pushWait()/popWait() block
+/// on condition variables, which are only notified while someone waits on them.
+template<typename T>
+class MutexQueue
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    explicit MutexQueue(size_type capacity) : capacity_{capacity} {}
+
+    MutexQueue(MutexQueue const&) = delete;
+    MutexQueue& operator=(MutexQueue const&) = delete;
+
+    /// Returns the number of elements in the queue
+    size_type size() const {
+        std::lock_guard lock{mutex_};
+        return items_.size();
+    }
+
+    /// Returns whether the container has no elements
+    bool empty() const { return size() == 0; }
+
+    /// Returns whether the container has capacity() elements
+    bool full() const { return size() == capacity_; }
+
+    /// Returns the number of elements that can be held in the queue
+    size_type capacity() const noexcept { return capacity_; }
+
+    /// Push one object onto the queue.
+    /// @return `true` if the operation is successful; `false` if the queue is full.
+    bool push(const T& value) {
+        std::unique_lock lock{mutex_};
+        if (items_.size() == capacity_) {
+            return false;
+        }
+        items_.push_back(value);
+        notify(lock, popWaiters_, notEmpty_);
+        return true;
+    }
+
+    /// Pop one object from the queue.
+    /// @return `true` if the pop operation is successful; `false` if the queue is empty.
+    bool pop(T& value) {
+        std::unique_lock lock{mutex_};
+        if (items_.empty()) {
+            return false;
+        }
+        value = std::move(items_.front());
+        items_.pop_front();
+        notify(lock, pushWaiters_, notFull_);
+        return true;
+    }
+
+    /// Push one object, waiting for room
+    void pushWait(const T& value) {
+        std::unique_lock lock{mutex_};
+        wait(lock, pushWaiters_, notFull_, [this] { return items_.size() < capacity_; });
+        items_.push_back(value);
+        notify(lock, popWaiters_, notEmpty_);
+    }
+
+    /// Pop one object, waiting for one to arrive
+    void popWait(T& value) {
+        std::unique_lock lock{mutex_};
+        wait(lock, popWaiters_, notEmpty_, [this] { return not items_.empty(); });
+        value = std::move(items_.front());
+        items_.pop_front();
+        notify(lock, pushWaiters_, notFull_);
+    }
+
+private:
+    template<typename Ready>
+    static void wait(std::unique_lock<std::mutex>& lock, size_type& waiters, std::condition_variable& cv, Ready ready) {
+        ++waiters;
+        cv.wait(lock, ready);
+        --waiters;
+    }
+
+    static void notify(std::unique_lock<std::mutex>& lock, size_type waiters, std::condition_variable& cv) {
+        if (waiters) {
+            lock.unlock();
+            cv.notify_one();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::deque<T> items_;
+    const size_type capacity_;
+    size_type popWaiters_{0};
+    size_type pushWaiters_{0};
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "SPSCLocal.hh"
+#include "full_fence.hh"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <system_error>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/// Owning wrapper around a non-blocking eventfd
+class EventFd
+{
+public:
+    EventFd()
+        : fd_{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}
+    {
+        if (fd_ == -1) {
+            throw std::system_error(errno, std::system_category(), "eventfd");
+        }
+    }
+
+    ~EventFd() { ::close(fd_); }
+
+    EventFd(EventFd const&) = delete;
+    EventFd& operator=(EventFd const&) = delete;
+
+    /// Descriptor to register with epoll/poll/select for EPOLLIN
+    int fd() const noexcept { return fd_; }
+
+    /// Makes the descriptor readable
+    void signal() const noexcept {
+        std::uint64_t one = 1;
+        while (::write(fd_, &one, sizeof(one)) == -1 and errno == EINTR) {
+            ;
+        }
+    }
+
+    /// Resets the descriptor to not readable.
+    /// @return the number of signals since the last reset.
+    std::uint64_t reset() const noexcept {
+        std::uint64_t count = 0;
+        while (::read(fd_, &count, sizeof(count)) == -1) {
+            if (errno != EINTR) {
+                return 0;
+            }
+        }
+        return count;
+    }
+
+private:
+    int fd_;
+};
+
+/// SPSCLocal whose consumer can sleep in an event loop on an eventfd.
+/// The consumer drains with pop() and, once empty, calls prepareToSleep() before waiting on
+/// fd(). The producer only signals the eventfd when it finds the consumer's sleeping flag set,
+/// i.e. on the empty to non-empty transition, so no syscall is made while the consumer drains.
+template<typename T, const int N = 1 << 17, typename Alloc = std::allocator<T>>
+class NotifyingSPSC
+{
+public:
+    using fifo_type = SPSCLocal<T, N, Alloc>;
+    using value_type = T;
+    using size_type = typename fifo_type::size_type;
+
+    explicit NotifyingSPSC(Alloc const& alloc = Alloc{})
+        : fifo_{alloc}
+    {}
+
+    NotifyingSPSC(NotifyingSPSC const&) = delete;
+    NotifyingSPSC& operator=(NotifyingSPSC const&) = delete;
+
+    /// Returns the number of elements in the fifo
+    auto size() const noexcept { return fifo_.size(); }
+
+    /// Returns whether the container has no elements
+    bool empty() const noexcept { return fifo_.empty(); }
+
+    /// Returns whether the container has capacity() elements
+    bool full() const noexcept { return fifo_.full(); }
+
+    /// Returns the number of elements that can be held in the fifo
+    size_type capacity() const noexcept { return fifo_.capacity(); }
+
+    /// Descriptor that becomes readable when a sleeping consumer has elements to pop
+    int fd() const noexcept { return event_.fd(); }
+
+    /// Push one object onto the fifo, signalling the eventfd if the consumer sleeps.
+    /// @return `true` if the operation is successful; `false` if fifo is full.
+    bool push(const T& value) {
+        if (not fifo_.push(value)) {
+            return false;
+        }
+        // Pairs with the fence in prepareToSleep(): either this load sees the flag or the
+        // consumer's empty() sees the element. The line stays shared while the flag is down;
+        // a consumer that re-armed after draining this element only gets a spurious wakeup.
+        fullFence();
+        if (sleeping_.load(std::memory_order_relaxed) and sleeping_.exchange(false, std::memory_order_acq_rel)) {
+            event_.signal();
+            ++signals_;
+        }
+        return true;
+    }
+
+    /// Pop one object from the fifo. Never blocks and never makes a syscall.
+    /// @return `true` if the pop operation is successful; `false` if fifo is empty.
+    bool pop(T& value) { return fifo_.pop(value); }
+
+    /// Arms the sleeping flag after pop() failed.
+    /// @return `true` if the consumer may wait on fd(); `false` if elements arrived meanwhile
+    /// and it should keep draining.
+    bool prepareToSleep() noexcept {
+        sleeping_.store(true, std::memory_order_relaxed);
+        fullFence();
+        if (fifo_.empty()) {
+            return true;
+        }
+        // Disarm; if the producer already claimed the flag the eventfd is left readable and
+        // the next wait returns immediately, which is harmless
+        sleeping_.exchange(false, std::memory_order_acq_rel);
+        return false;
+    }
+
+    /// Clears the eventfd after the event loop reported it readable.
+    void acknowledge() const noexcept { event_.reset(); }
+
+    /// Number of eventfd writes made by the producer; read from the producer thread
+    std::uint64_t signals() const noexcept { return signals_; }
+
+private:
+    fifo_type fifo_;
+    EventFd event_;
+
+    /// Exclusive to the push thread
+    alignas(CACHE_LINE_SIZE) std::uint64_t signals_{};
+
+    /// Set by the pop thread before it sleeps; cleared by whichever side gets there first
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> sleeping_{false};
+
+    char padding_[CACHE_LINE_SIZE - sizeof(std::atomic<bool>)];
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "SPSCLocal.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/// What happens to staged elements that do not fit into their partition's ring
+enum class PartitionFull
+{
+    /// The producer yields until the partition's consumer makes room
+    Block,
+    /// The rest goes to the partition's unbounded overflow buffer, in order; the buffer is
+    /// drained into the ring before anything newer on every later flush
+    Spill,
+    /// The rest stays staged; dispatch() returns `false` once the stage itself is full
+    Report,
+};
+
+/// One producer spreading elements over N SPSC rings, one per consumer thread, by a
+/// user-provided key: every element with the same key goes to partition
+/// `key(value) % partitions()`, so per-key order is kept. Elements are staged per
+/// partition and pushed `batch` at a time, with pushBulk() where the queue has it, so one
+/// cursor publish covers the whole batch. Staged elements are invisible to consumers
+/// until their batch fills or the producer calls flush(), e.g. whenever its input runs dry.
+template<typename Queue = SPSCLocal<std::int64_t, 1 << 12>, typename Key = std::hash<typename Queue::value_type>>
+class PartitionedDispatcher
+{
+public:
+    using queue_type = Queue;
+    using value_type = typename Queue::value_type;
+    using size_type = std::size_t;
+
+    explicit PartitionedDispatcher(size_type partitions, Key key = Key{}, PartitionFull policy = PartitionFull::Block,
+                                   size_type batch = 32)
+        : count_{checkedPartitions(partitions, batch)}
+        , batch_{batch}
+        , policy_{policy}
+        , key_{std::move(key)}
+        , queues_{new Queue[count_]}
+        , partitions_(count_)
+    {
+        for (auto& partition : partitions_) {
+            partition.staged.reserve(batch);
+        }
+    }
+
+    PartitionedDispatcher(PartitionedDispatcher const&) = delete;
+    PartitionedDispatcher& operator=(PartitionedDispatcher const&) = delete;
+
+    /// Returns the number of partitions
+    size_type partitions() const noexcept { return count_; }
+
+    /// The ring of partition `index`; its consumer pops from it
+    Queue& queue(size_type index) noexcept { return queues_[index]; }
+
+    /// Partition an element is routed to
+    size_type partitionOf(const value_type& value) const { return static_cast<size_type>(key_(value)) % count_; }
+
+    /// Stages one element for its partition and pushes the batch once it is full.
+    /// Producer only.
+    /// @return `true` if the element was accepted; `false` only under PartitionFull::Report,
+    /// when both the ring and the stage of its partition are full.
+    bool dispatch(const value_type& value) {
+        auto index = partitionOf(value);
+        auto& staged = partitions_[index].staged;
+        if (staged.size() == batch_) {
+            flushPartition(index);
+            if (staged.size() == batch_) {
+                return false;
+            }
+        }
+        staged.push_back(value);
+        if (staged.size() == batch_) {
+            flushPartition(index);
+        }
+        return true;
+    }
+
+    /// Pushes every staged element (and spilled ones first). Producer only.
+    /// @return the number of elements still held back: staged under Report, spilled under Spill.
+    size_type flush() {
+        size_type pending = 0;
+        for (size_type index = 0; index < count_; ++index) {
+            flushPartition(index);
+            pending += partitions_[index].staged.size() + partitions_[index].overflow.size();
+        }
+        return pending;
+    }
+
+    /// Elements moved to overflow buffers so far (Spill)
+    size_type spilled() const noexcept { return spilled_; }
+
+    /// Flushes that found a partition's ring full
+    size_type stalls() const noexcept { return stalls_; }
+
+private:
+    struct Partition {
+        std::vector<value_type> staged;
+        std::deque<value_type> overflow;
+    };
+
+    static size_type checkedPartitions(size_type partitions, size_type batch) {
+        if (partitions == 0 or batch == 0) {
+            throw std::invalid_argument("PartitionedDispatcher needs at least one partition and a batch of one");
+        }
+        return partitions;
+    }
+
+    /// Pushes up to `count` elements, in one bulk copy when the queue supports it
+    static size_type pushSome(Queue& queue, const value_type* values, size_type count) {
+        if constexpr (requires { queue.pushBulk(values, count); }) {
+            return queue.pushBulk(values, count);
+        } else {
+            size_type pushed = 0;
+            while (pushed < count and queue.push(values[pushed])) {
+                ++pushed;
+            }
+            return pushed;
+        }
+    }
+
+    void flushPartition(size_type index) {
+        auto& queue = queues_[index];
+        auto& [staged, overflow] = partitions_[index];
+        while (not overflow.empty() and queue.push(overflow.front())) {
+            overflow.pop_front();
+        }
+        if (not overflow.empty()) {
+            // Everything newer queues up behind the spilled elements
+            ++stalls_;
+            spilled_ += staged.size();
+            overflow.insert(overflow.end(), staged.begin(), staged.end());
+            staged.clear();
+            return;
+        }
+
+        auto pushed = pushSome(queue, staged.data(), staged.size());
+        if (pushed == staged.size()) {
+            staged.clear();
+            return;
+        }
+        ++stalls_;
+        switch (policy_) {
+        case PartitionFull::Block:
+            while (pushed < staged.size()) {
+                std::this_thread::yield();
+                pushed += pushSome(queue, staged.data() + pushed, staged.size() - pushed);
+            }
+            staged.clear();
+            break;
+        case PartitionFull::Spill:
+            spilled_ += staged.size() - pushed;
+            overflow.insert(overflow.end(), staged.begin() + pushed, staged.end());
+            staged.clear();
+            break;
+        case PartitionFull::Report:
+            staged.erase(staged.begin(), staged.begin() + pushed);
+            break;
+        }
+    }
+
+    size_type count_;
+    size_type batch_;
+    PartitionFull policy_;
+    Key key_;
+    std::unique_ptr<Queue[]> queues_;
+    std::vector<Partition> partitions_;
+    size_type spilled_{0};
+    size_type stalls_{0};
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "SPSCLocal.hh"
+#include "thread_utils.hh"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// Queue used between stages unless the pipeline is given another one
+template<typename T>
+using DefaultPipelineQueue = SPSCLocal<T, 1 << 12>;
+
+struct PipelineConfig
+{
+    /// CPU for each stage thread, in stage order; missing or negative entries stay unpinned
+    std::vector<int> cpus;
+    /// mlockall() current and future pages before the stage threads start
+    bool lockMemory{false};
+    /// SCHED_FIFO priority of the stage threads; 0 keeps the default scheduling policy
+    int realtimePriority{0};
+};
+
+namespace pipeline_detail {
+
+template<typename... Ts>
+struct TypeList {};
+
+template<typename T, typename List>
+struct Prepend;
+
+template<typename T, typename... Ts>
+struct Prepend<T, TypeList<Ts...>> {
+    using type = TypeList<T, Ts...>;
+};
+
+/// Element types flowing through the stages: the input, then each stage's result.
+/// A sink stage returns void, which ends the list.
+template<typename In, typename... Stages>
+struct Flow {
+    using type = TypeList<In>;
+};
+
+template<>
+struct Flow<void> {
+    using type = TypeList<>;
+};
+
+template<typename In, typename Stage, typename... Rest>
+struct Flow<In, Stage, Rest...> {
+    using Out = std::invoke_result_t<Stage&, In&&>;
+    using type = typename Prepend<In, typename Flow<Out, Rest...>::type>::type;
+};
+
+/// One queue per element type
+template<template<typename> class Queue, typename List>
+struct Queues;
+
+template<template<typename> class Queue, typename... Ts>
+struct Queues<Queue, TypeList<Ts...>> {
+    using type = std::tuple<Queue<Ts>...>;
+};
+
+}  // namespace pipeline_detail
+
+/// Chain of stage threads connected by SPSC queues.
+/// Stage k pops from queue k, invokes the k-th callable and pushes its result onto queue k+1.
+/// The caller feeds queue 0 with push(); if the last stage returns a value the caller reads
+/// it back with pop(), otherwise the last stage is a sink. Elements must be default
+/// constructible. stop() closes the input and joins the stages once every queue has drained.
+template<typename In, template<typename> class Queue, typename... Stages>
+class Pipeline
+{
+    using Flow = typename pipeline_detail::Flow<In, Stages...>::type;
+    using QueueTuple = typename pipeline_detail::Queues<Queue, Flow>::type;
+
+public:
+    static constexpr std::size_t stages = sizeof...(Stages);
+    static constexpr bool hasOutput = std::tuple_size_v<QueueTuple> > stages;
+
+    static_assert(stages > 0, "a pipeline needs at least one stage");
+
+    explicit Pipeline(PipelineConfig config, Stages... stage)
+        : config_{std::move(config)}
+        , stages_{std::move(stage)...}
+    {}
+
+    Pipeline(Pipeline const&) = delete;
+    Pipeline& operator=(Pipeline const&) = delete;
+
+    ~Pipeline() { stop(); }
+
+    /// Spawns, pins and prioritises the stage threads.
+    /// @throw std::system_error if pinning, memory locking or SCHED_FIFO is requested but refused.
+    void start() {
+        if (config_.lockMemory and lockMemory() == -1) {
+            throw std::system_error(errno, std::system_category(), "mlockall");
+        }
+        spawn(std::make_index_sequence<stages>{});
+        for (auto k = std::size_t{}; k < stages; ++k) {
+            auto handle = threads_[k].native_handle();
+            if (k < config_.cpus.size()) {
+                if (auto error = pinThread(config_.cpus[k], handle)) {
+                    stop();
+                    throw std::system_error(error, std::system_category(), "pthread_setaffinity_np");
+                }
+            }
+            if (config_.realtimePriority > 0) {
+                if (auto error = setRealtimePriority(config_.realtimePriority, handle)) {
+                    stop();
+                    throw std::system_error(error, std::system_category(), "pthread_setschedparam");
+                }
+            }
+        }
+    }
+
+    /// Feed one element to the first stage; must be called from a single thread.
+    /// @return `true` if the operation is successful; `false` if the first queue is full.
+    bool push(const In& value) { return std::get<0>(queues_).push(value); }
+
+    /// Take one result of the last stage; must be called from a single thread.
+    /// @return `true` if the pop operation is successful; `false` if no result is ready.
+    template<typename Out>
+    requires hasOutput
+    bool pop(Out& value) { return std::get<stages>(queues_).pop(value); }
+
+    /// No more input will be pushed; the stages drain their queues and exit.
+    void close() noexcept { closed_.store(true, std::memory_order_release); }
+
+    /// Returns whether every stage has drained and exited
+    bool finished() const noexcept { return done_[stages - 1].value.load(std::memory_order_acquire); }
+
+    /// Close the input and wait for the stages to drain. A pipeline with an output queue
+    /// must have it drained concurrently (see finished()), or the last stage may never exit.
+    void stop() {
+        close();
+        for (auto& th : threads_) {
+            if (th.joinable()) {
+                th.join();
+            }
+        }
+    }
+
+private:
+    template<std::size_t... K>
+    void spawn(std::index_sequence<K...>) {
+        (threads_.emplace_back([this] { run<K>(); }), ...);
+    }
+
+    template<std::size_t K>
+    void run() {
+        auto& in = std::get<K>(queues_);
+        auto& upstreamDone = upstream<K>();
+        typename std::remove_reference_t<decltype(in)>::value_type value;
+
+        while (true) {
+            if (in.pop(value)) {
+                process<K>(std::move(value));
+                continue;
+            }
+            // Everything upstream pushed is visible once its done flag is; drain it and exit
+            if (upstreamDone.load(std::memory_order_acquire)) {
+                while (in.pop(value)) {
+                    process<K>(std::move(value));
+                }
+                break;
+            }
+        }
+        done_[K].value.store(true, std::memory_order_release);
+    }
+
+    /// Flag set once nothing more will be pushed onto queue K
+    template<std::size_t K>
+    std::atomic<bool>& upstream() noexcept {
+        if constexpr (K == 0) {
+            return closed_;
+        } else {
+            return done_[K - 1].value;
+        }
+    }
+
+    template<std::size_t K, typename T>
+    void process(T&& value) {
+        auto& stage = std::get<K>(stages_);
+        if constexpr (K + 1 < std::tuple_size_v<QueueTuple>) {
+            auto& out = std::get<K + 1>(queues_);
+            auto result = std::invoke(stage, std::forward<T>(value));
+            while (not out.push(result)) {
+                ;
+            }
+        } else {
+            std::invoke(stage, std::forward<T>(value));
+        }
+    }
+
+    struct alignas(CACHE_LINE_SIZE) Flag {
+        std::atomic<bool> value{false};
+    };
+
+    PipelineConfig config_;
+    std::tuple<Stages...> stages_;
+    QueueTuple queues_;
+    std::vector<std::thread> threads_;
+
+    /// Set by the caller once no more input will be pushed
+    std::atomic<bool> closed_{false};
+
+    /// done_[k] is set by stage k after it drained its input and exited
+    std::array<Flag, stages> done_;
+};
+
+/// Builds a pipeline whose stages are connected by `Queue<T>` for each element type T.
+template<typename In, template<typename> class Queue = DefaultPipelineQueue, typename... Stages>
+auto makePipeline(PipelineConfig config, Stages... stage) {
+    return Pipeline<In, Queue, Stages...>{std::move(config), std::move(stage)...};
+}
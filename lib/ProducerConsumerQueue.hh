@@ -0,0 +1,178 @@
+/**
+ * Header-only rewrite of folly::ProducerConsumerQueue
+ * (folly/ProducerConsumerQueue.h, https://github.com/facebook/folly, Apache License 2.0):
+ * same interface and algorithm, without the folly dependencies, so it can be benchmarked
+ * next to the queues in this repo.
+ */
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Modified from the original: the folly includes are replaced by standard headers and
+// hardware_destructive_interference_size by cacheLineSize from cache_line.hh.
+
+#pragma once
+
+#include "cache_line.hh"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace folly {
+
+/// Bounded SPSC queue as folly ships it: one slot stays empty to tell full from empty,
+/// indices wrap with a compare instead of a mask, and neither side caches the other's
+/// index, so every write() and read() loads the other thread's cursor.
+template<typename T>
+struct ProducerConsumerQueue {
+    using value_type = T;
+
+    ProducerConsumerQueue(const ProducerConsumerQueue&) = delete;
+    ProducerConsumerQueue& operator=(const ProducerConsumerQueue&) = delete;
+
+    /// `size` must be at least 2; the queue holds at most size - 1 elements
+    explicit ProducerConsumerQueue(std::uint32_t size)
+        : size_(size)
+        , records_(static_cast<T*>(std::malloc(sizeof(T) * size)))
+        , readIndex_(0)
+        , writeIndex_(0)
+    {
+        assert(size >= 2);
+        if (!records_) {
+            throw std::bad_alloc();
+        }
+    }
+
+    ~ProducerConsumerQueue() {
+        if (!std::is_trivially_destructible<T>::value) {
+            std::size_t readIndex = readIndex_;
+            std::size_t endIndex = writeIndex_;
+            while (readIndex != endIndex) {
+                records_[readIndex].~T();
+                if (++readIndex == size_) {
+                    readIndex = 0;
+                }
+            }
+        }
+        std::free(records_);
+    }
+
+    template<class... Args>
+    bool write(Args&&... recordArgs) {
+        auto const currentWrite = writeIndex_.load(std::memory_order_relaxed);
+        auto nextRecord = currentWrite + 1;
+        if (nextRecord == size_) {
+            nextRecord = 0;
+        }
+        if (nextRecord != readIndex_.load(std::memory_order_acquire)) {
+            new (&records_[currentWrite]) T(std::forward<Args>(recordArgs)...);
+            writeIndex_.store(nextRecord, std::memory_order_release);
+            return true;
+        }
+
+        // queue is full
+        return false;
+    }
+
+    /// Move (or copy) the value at the front of the queue to the given variable
+    bool read(T& record) {
+        auto const currentRead = readIndex_.load(std::memory_order_relaxed);
+        if (currentRead == writeIndex_.load(std::memory_order_acquire)) {
+            // queue is empty
+            return false;
+        }
+
+        auto nextRecord = currentRead + 1;
+        if (nextRecord == size_) {
+            nextRecord = 0;
+        }
+        record = std::move(records_[currentRead]);
+        records_[currentRead].~T();
+        readIndex_.store(nextRecord, std::memory_order_release);
+        return true;
+    }
+
+    /// Pointer to the value at the front of the queue (for use in-place) or nullptr if empty
+    T* frontPtr() {
+        auto const currentRead = readIndex_.load(std::memory_order_relaxed);
+        if (currentRead == writeIndex_.load(std::memory_order_acquire)) {
+            // queue is empty
+            return nullptr;
+        }
+        return &records_[currentRead];
+    }
+
+    /// queue must not be empty
+    void popFront() {
+        auto const currentRead = readIndex_.load(std::memory_order_relaxed);
+        assert(currentRead != writeIndex_.load(std::memory_order_acquire));
+
+        auto nextRecord = currentRead + 1;
+        if (nextRecord == size_) {
+            nextRecord = 0;
+        }
+        records_[currentRead].~T();
+        readIndex_.store(nextRecord, std::memory_order_release);
+    }
+
+    bool isEmpty() const {
+        return readIndex_.load(std::memory_order_acquire) == writeIndex_.load(std::memory_order_acquire);
+    }
+
+    bool isFull() const {
+        auto nextRecord = writeIndex_.load(std::memory_order_acquire) + 1;
+        if (nextRecord == size_) {
+            nextRecord = 0;
+        }
+        if (nextRecord != readIndex_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        // queue is full
+        return true;
+    }
+
+    /// Exact from either side while the other is idle, approximate otherwise
+    std::size_t sizeGuess() const {
+        int ret = writeIndex_.load(std::memory_order_acquire) - readIndex_.load(std::memory_order_acquire);
+        if (ret < 0) {
+            ret += size_;
+        }
+        return ret;
+    }
+
+    /// Maximum number of items in the queue
+    std::size_t capacity() const { return size_ - 1; }
+
+private:
+    using AtomicIndex = std::atomic<unsigned int>;
+
+    char pad0_[cacheLineSize];
+    const std::uint32_t size_;
+    T* const records_;
+
+    alignas(cacheLineSize) AtomicIndex readIndex_;
+    alignas(cacheLineSize) AtomicIndex writeIndex_;
+
+    char pad1_[cacheLineSize - sizeof(AtomicIndex)];
+};
+
+} // namespace folly
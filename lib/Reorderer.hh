@@ -0,0 +1,144 @@
+#pragma once
+
+#include "SPSCLocal.hh"
+#include "require.hh"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+/// An element tagged with its position in the original order
+template<typename T>
+struct Sequenced {
+    std::uint64_t sequence;
+    T value;
+};
+
+/// Reassembly stage behind parallel workers: each worker pushes its results, tagged with
+/// the sequence numbers they were dispatched with, onto its own SPSC queue, and the
+/// consumer emits them in sequence order. Early results wait in a preallocated window of
+/// `Window` slots indexed by `sequence & (Window - 1)`, so nothing is allocated per
+/// element. A result more than Window - 1 ahead of the next expected sequence stays parked
+/// in front of its queue, which then holds that worker back until the gap closes. Each
+/// worker must push its results in increasing sequence order, and every sequence number
+/// from 0 on must arrive exactly once.
+template<typename T, const std::size_t Window = 1024, typename Queue = SPSCLocal<Sequenced<T>, 1 << 12>>
+requires power_of_two<Window>
+class Reorderer
+{
+public:
+    using value_type = T;
+    using queue_type = Queue;
+    using size_type = std::size_t;
+
+    explicit Reorderer(size_type workers)
+        : count_{checkedWorkers(workers)}
+        , queues_{new Queue[count_]}
+        , parked_(count_)
+        , window_{new Slot[Window]}
+    {}
+
+    Reorderer(Reorderer const&) = delete;
+    Reorderer& operator=(Reorderer const&) = delete;
+
+    /// Returns the number of worker queues
+    size_type workers() const noexcept { return count_; }
+
+    /// Direct access to a worker's queue
+    Queue& queue(size_type worker) noexcept { return queues_[worker]; }
+
+    /// Hands one result to the reorderer; must only be called by worker `worker`.
+    /// @return `true` if the operation is successful; `false` if the worker's queue is full.
+    bool push(size_type worker, std::uint64_t sequence, const T& value) {
+        assert(worker < count_);
+        return queues_[worker].push(Sequenced<T>{sequence, value});
+    }
+
+    /// Collects results from every worker queue and delivers the ones that are next in
+    /// order as `f(sequence, value)`. Must only be called by the consumer thread.
+    /// @return the number of elements delivered.
+    template<typename F>
+    size_type poll(F&& f) {
+        size_type delivered = 0;
+        Sequenced<T> item;
+        for (size_type worker = 0; worker < count_; ++worker) {
+            auto& parked = parked_[worker];
+            if (parked) {
+                if (not fits(parked->sequence)) {
+                    continue;
+                }
+                delivered += accept(*parked, f);
+                parked.reset();
+            }
+            auto& queue = queues_[worker];
+            while (queue.pop(item)) {
+                if (not fits(item.sequence)) {
+                    parked = item;
+                    break;
+                }
+                delivered += accept(item, f);
+            }
+        }
+        return delivered;
+    }
+
+    /// Sequence number of the next element to deliver
+    std::uint64_t next() const noexcept { return next_; }
+
+    /// Elements waiting in the window for an earlier one
+    size_type waiting() const noexcept { return waiting_; }
+
+private:
+    struct Slot {
+        bool present = false;
+        T value{};
+    };
+
+    static size_type checkedWorkers(size_type workers) {
+        if (workers == 0) {
+            throw std::invalid_argument("Reorderer needs at least one worker queue");
+        }
+        return workers;
+    }
+
+    bool fits(std::uint64_t sequence) const noexcept { return sequence - next_ < Window; }
+
+    /// Delivers `item` if it is next, followed by every consecutive one already waiting;
+    /// otherwise stores it in its window slot
+    template<typename F>
+    size_type accept(Sequenced<T>& item, F& f) {
+        assert(item.sequence >= next_ and "sequence delivered twice");
+        if (item.sequence != next_) {
+            auto& slot = window_[item.sequence & bit_mask_of<Window>];
+            assert(not slot.present);
+            slot.value = std::move(item.value);
+            slot.present = true;
+            ++waiting_;
+            return 0;
+        }
+        f(next_, item.value);
+        size_type delivered = 1;
+        ++next_;
+        for (auto* slot = &window_[next_ & bit_mask_of<Window>]; slot->present; slot = &window_[next_ & bit_mask_of<Window>]) {
+            f(next_, slot->value);
+            slot->present = false;
+            --waiting_;
+            ++delivered;
+            ++next_;
+        }
+        return delivered;
+    }
+
+    // Consumer-local state
+    size_type count_;
+    std::unique_ptr<Queue[]> queues_;
+    /// Per worker: a popped result too far ahead to enter the window yet
+    std::vector<std::optional<Sequenced<T>>> parked_;
+    std::unique_ptr<Slot[]> window_;
+    std::uint64_t next_{0};
+    size_type waiting_{0};
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/// How released ring pages are handed back: DontNeed drops them (and their RSS) at once;
+/// Free lets the kernel take them lazily under memory pressure, which is cheaper when the
+/// producer comes back soon but leaves RSS unchanged until then
+enum class ReclaimAdvice { DontNeed, Free };
+
+/// Allocator for large rings that reserves address space instead of committing memory:
+/// the mapping is MAP_NORESERVE, pages fault in as the producer first reaches them, and a
+/// queue can hand drained pages back with release() while it runs. SPSCLocal checks
+/// `reclaimable` to enable its page handshake and reclaim(). sizeof(T) must be a power of
+/// two no larger than a page and n * sizeof(T) a multiple of the page size, otherwise
+/// allocate() throws std::invalid_argument; failing system calls throw std::system_error.
+template<typename T, ReclaimAdvice Advice = ReclaimAdvice::DontNeed>
+class ReservedAllocator
+{
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind { using other = ReservedAllocator<U, Advice>; };
+
+    /// Queues check this to release pages of the free part of the ring
+    static constexpr bool reclaimable = true;
+
+    ReservedAllocator() noexcept = default;
+
+    template<typename U>
+    ReservedAllocator(ReservedAllocator<U, Advice> const&) noexcept {}
+
+    static std::size_t pageSize() noexcept {
+        return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    }
+
+    T* allocate(std::size_t n) {
+        static_assert(std::has_single_bit(sizeof(T)), "reserved rings need power-of-two sized elements");
+        // Queues release whole pages by element index, which needs at least one element per page
+        if (sizeof(T) > pageSize()) {
+            throw std::invalid_argument("reserved ring elements of " + std::to_string(sizeof(T)) +
+                                        " bytes are larger than a page");
+        }
+        const auto bytes = n * sizeof(T);
+        if (bytes == 0 or bytes % pageSize() != 0) {
+            throw std::invalid_argument("reserved ring of " + std::to_string(bytes) +
+                                        " bytes is not a multiple of the page size");
+        }
+        auto* ring = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (ring == MAP_FAILED) {
+            throw std::system_error(errno, std::system_category(), "mmap");
+        }
+        return static_cast<T*>(ring);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        ::munmap(p, n * sizeof(T));
+    }
+
+    /// Returns the pages of `n` elements at `p` to the kernel; both must be page aligned.
+    /// The next write faults in a zeroed page.
+    void release(T* p, std::size_t n) noexcept {
+#ifdef MADV_FREE
+        constexpr int advice = Advice == ReclaimAdvice::Free ? MADV_FREE : MADV_DONTNEED;
+#else
+        constexpr int advice = MADV_DONTNEED;
+#endif
+        ::madvise(p, n * sizeof(T), advice);
+    }
+
+    /// Bytes of `n` elements at page-aligned `p` that are resident in memory (mincore)
+    static std::size_t residentBytes(const T* p, std::size_t n) {
+        const auto page = pageSize();
+        const auto bytes = n * sizeof(T);
+        std::vector<unsigned char> pages((bytes + page - 1) / page);
+        if (::mincore(const_cast<T*>(p), bytes, pages.data()) == -1) {
+            throw std::system_error(errno, std::system_category(), "mincore");
+        }
+        std::size_t resident = 0;
+        for (auto flags : pages) {
+            resident += flags & 1;
+        }
+        return resident * page;
+    }
+
+    template<typename U>
+    bool operator==(ReservedAllocator<U, Advice> const&) const noexcept { return true; }
+};
+
+/// Consumer-side reclamation policy for a queue with a reclaimable allocator: once the
+/// queue has held at most `lowWatermark` elements for `interval`, poll() releases the cold
+/// part of the ring, then waits another interval before doing it again. Call poll() from
+/// the consumer thread wherever it idles, e.g. when pop() finds the queue empty.
+template<typename Queue>
+class IdleReclaimer
+{
+public:
+    static_assert(Queue::reclaimable, "IdleReclaimer needs a queue with a reclaimable allocator");
+
+    using clock = std::chrono::steady_clock;
+
+    IdleReclaimer(Queue& queue, std::size_t lowWatermark, clock::duration interval) noexcept
+        : queue_{queue}
+        , lowWatermark_{lowWatermark}
+        , interval_{interval}
+    {}
+
+    /// @return the number of bytes released by this call
+    std::size_t poll(clock::time_point now = clock::now()) noexcept {
+        if (queue_.size() > lowWatermark_) {
+            quietSince_.reset();
+            return 0;
+        }
+        if (not quietSince_) {
+            quietSince_ = now;
+            return 0;
+        }
+        if (now - *quietSince_ < interval_) {
+            return 0;
+        }
+        quietSince_ = now;
+        auto released = queue_.reclaim();
+        released_ += released;
+        ++reclaims_;
+        return released;
+    }
+
+    /// Bytes released so far; pages faulted in again in between count again
+    std::size_t released() const noexcept { return released_; }
+
+    /// Number of reclaim() calls so far
+    std::size_t reclaims() const noexcept { return reclaims_; }
+
+private:
+    Queue& queue_;
+    const std::size_t lowWatermark_;
+    const clock::duration interval_;
+    std::optional<clock::time_point> quietSince_;
+    std::size_t released_ = 0;
+    std::size_t reclaims_ = 0;
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "cache_line.hh"
+#include "queue_probes.hh"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+/// SPSCLocal protocol in a compact layout for deployments with many queues: the producer's
+/// cursor and its cached copy of the consumer cursor share one cache line, the consumer's
+/// pair another, and the ring follows directly in the same allocation. Cursors are 32 bits
+/// wide whenever N allows it (wrap-around is harmless with a power-of-two capacity).
+/// The header is exactly two cache lines. Instances are created with create(), or placed
+/// into caller-provided memory of allocationSize() bytes with construct().
+template<typename T, const int N = 1 << 10>
+class SPSCCompact
+{
+public:
+    using value_type = T;
+    using size_type = std::conditional_t<(N <= (1 << 30)), std::uint32_t, std::size_t>;
+
+    static_assert(N > 1 and (N & (N - 1)) == 0, "capacity must be a power of two");
+    static_assert(alignof(T) <= CACHE_LINE_SIZE);
+
+    struct Deleter {
+        void operator()(SPSCCompact* fifo) const noexcept {
+            fifo->~SPSCCompact();
+            ::operator delete(fifo, std::align_val_t{CACHE_LINE_SIZE});
+        }
+    };
+
+    using Ptr = std::unique_ptr<SPSCCompact, Deleter>;
+
+    /// Bytes needed for the header and the ring together
+    static constexpr std::size_t allocationSize() noexcept { return sizeof(SPSCCompact) + sizeof(T) * N; }
+
+    /// Allocates header and ring as one cache line aligned block
+    static Ptr create() {
+        auto* memory = ::operator new(allocationSize(), std::align_val_t{CACHE_LINE_SIZE});
+        return Ptr{construct(memory)};
+    }
+
+    /// Constructs a queue in `memory`, which must be CACHE_LINE_SIZE aligned and hold
+    /// allocationSize() bytes; destroy it with ~SPSCCompact() before releasing the memory
+    static SPSCCompact* construct(void* memory) noexcept {
+        assert(reinterpret_cast<std::uintptr_t>(memory) % CACHE_LINE_SIZE == 0);
+        return new (memory) SPSCCompact{};
+    }
+
+    SPSCCompact(SPSCCompact const&) = delete;
+    SPSCCompact& operator=(SPSCCompact const&) = delete;
+
+    ~SPSCCompact() {
+        auto pushCursor = producer_.pushCursor.load(std::memory_order_relaxed);
+        for (auto popCursor = consumer_.popCursor.load(std::memory_order_relaxed); popCursor != pushCursor; ++popCursor) {
+            element(popCursor)->~T();
+        }
+    }
+
+    /// Returns the number of elements in the fifo
+    auto size() const noexcept {
+        auto pushCursor = producer_.pushCursor.load(std::memory_order_relaxed);
+        auto popCursor = consumer_.popCursor.load(std::memory_order_relaxed);
+
+        return static_cast<size_type>(pushCursor - popCursor);
+    }
+
+    /// Returns whether the container has no elements
+    bool empty() const noexcept { return size() == 0; }
+
+    /// Returns whether the container has capacity() elements
+    bool full() const noexcept { return size() == capacity(); }
+
+    /// Returns the number of elements that can be held in the fifo
+    size_type capacity() const noexcept { return N; }
+
+    /// Push one object onto the fifo.
+    /// @return `true` if the operation is successful; `false` if fifo is full.
+    bool push(const T& value) {
+        size_type pushCur = producer_.pushCursor.load(std::memory_order_relaxed);
+        if (static_cast<size_type>(pushCur - producer_.popLocal) == N) {
+            producer_.popLocal = consumer_.popCursor.load(std::memory_order_acquire);
+            QUEUE_PROBE(push_refresh, this, pushCur, producer_.popLocal);
+            if (static_cast<size_type>(pushCur - producer_.popLocal) == N) {
+                QUEUE_PROBE(push_full, this, pushCur, producer_.popLocal);
+                return false;
+            }
+        }
+        new (element(pushCur)) T(value);
+        producer_.pushCursor.store(pushCur + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Pop one object from the fifo.
+    /// @return `true` if the pop operation is successful; `false` if fifo is empty.
+    bool pop(T& value) {
+        size_type popCur = consumer_.popCursor.load(std::memory_order_relaxed);
+        if (consumer_.pushLocal == popCur) {
+            consumer_.pushLocal = producer_.pushCursor.load(std::memory_order_acquire);
+            QUEUE_PROBE(pop_refresh, this, popCur, consumer_.pushLocal);
+            if (consumer_.pushLocal == popCur) {
+                QUEUE_PROBE(pop_empty, this, popCur, consumer_.pushLocal);
+                return false;
+            }
+        }
+        value = *element(popCur);
+        element(popCur)->~T();
+        consumer_.popCursor.store(popCur + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    SPSCCompact() = default;
+
+    T* element(size_type cursor) const noexcept {
+        auto* ring = reinterpret_cast<T*>(const_cast<SPSCCompact*>(this) + 1);
+        return ring + (cursor & bit_mask);
+    }
+
+    static constexpr size_type bit_mask = N - 1;
+
+    using CursorType = std::atomic<size_type>;
+    static_assert(CursorType::is_always_lock_free);
+
+    /// Everything the producer writes: its cursor, loaded by the consumer, and its cached
+    /// copy of the consumer cursor
+    struct alignas(CACHE_LINE_SIZE) Producer {
+        CursorType pushCursor{0};
+        size_type popLocal{0};
+    };
+
+    /// Everything the consumer writes
+    struct alignas(CACHE_LINE_SIZE) Consumer {
+        CursorType popCursor{0};
+        size_type pushLocal{0};
+    };
+
+    Producer producer_;
+    Consumer consumer_;
+};
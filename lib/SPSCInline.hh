@@ -0,0 +1,104 @@
+#pragma once
+
+#include "cache_line.hh"
+#include "queue_probes.hh"
+#include "require.hh"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/// SPSCLocal protocol with the ring embedded in the queue object: the cursor blocks come
+/// first, each on its own cache line, followed by the ring as a cache line aligned
+/// std::array. Every slot is at a constant offset from `this`, with no ring pointer to
+/// load and no second allocation, which suits small queues (64 to 4096 slots) embedded in
+/// other objects. The queue holds no pointers and its cursors are lock-free, so it works
+/// in static (constinit), stack or shared-memory storage; across processes T must be
+/// trivially copyable. Slots are assigned rather than constructed in place, so T must be
+/// default constructible.
+template<typename T, const int N = 1 << 10>
+requires power_of_two<N>
+class SPSCInline
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static_assert(std::is_default_constructible_v<T> and std::is_copy_assignable_v<T>);
+
+    constexpr SPSCInline() noexcept(std::is_nothrow_default_constructible_v<T>) = default;
+
+    SPSCInline(SPSCInline const&) = delete;
+    SPSCInline& operator=(SPSCInline const&) = delete;
+
+    /// Returns the number of elements in the fifo
+    inline auto size() const noexcept {
+        auto pushCursor = pushCursor_.load(std::memory_order_relaxed);
+        auto popCursor = popCursor_.load(std::memory_order_relaxed);
+
+        return pushCursor - popCursor;
+    }
+
+    /// Returns whether the container has no elements
+    inline bool empty() const noexcept { return size() == 0; }
+
+    /// Returns whether the container has capacity() elements
+    inline bool full() const noexcept { return size() == capacity(); }
+
+    /// Returns the number of elements that can be held in the fifo
+    static constexpr size_type capacity() noexcept { return N; }
+
+    /// Push one object onto the fifo.
+    /// @return `true` if the operation is successful; `false` if fifo is full.
+    bool push(const T& value) {
+        size_type pushCur = pushCursor_.load(std::memory_order_relaxed);
+        if (pushCur - popLocal_ == N) {
+            popLocal_ = popCursor_.load(std::memory_order_acquire);
+            QUEUE_PROBE(push_refresh, this, pushCur, popLocal_);
+            if (pushCur - popLocal_ == N) {
+                QUEUE_PROBE(push_full, this, pushCur, popLocal_);
+                return false;
+            }
+        }
+        ring_[pushCur & bit_mask_of<N>] = value;
+        pushCursor_.store(pushCur + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Pop one object from the fifo.
+    /// @return `true` if the pop operation is successful; `false` if fifo is empty.
+    bool pop(T& value) {
+        size_type popCur = popCursor_.load(std::memory_order_relaxed);
+        if (pushLocal_ == popCur) {
+            pushLocal_ = pushCursor_.load(std::memory_order_acquire);
+            QUEUE_PROBE(pop_refresh, this, popCur, pushLocal_);
+            if (pushLocal_ == popCur) {
+                QUEUE_PROBE(pop_empty, this, popCur, pushLocal_);
+                return false;
+            }
+        }
+        value = std::move(ring_[popCur & bit_mask_of<N>]);
+        popCursor_.store(popCur + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    using CursorType = std::atomic<size_type>;
+    static_assert(CursorType::is_always_lock_free);
+
+    /// Loaded and stored by the push thread; loaded by the pop thread
+    alignas(CACHE_LINE_SIZE) CursorType pushCursor_{0};
+
+    /// Producer's cached copy of popCursor_
+    alignas(CACHE_LINE_SIZE) size_type popLocal_{0};
+
+    /// Loaded and stored by the pop thread; loaded by the push thread
+    alignas(CACHE_LINE_SIZE) CursorType popCursor_{0};
+
+    /// Consumer's cached copy of pushCursor_
+    alignas(CACHE_LINE_SIZE) size_type pushLocal_{0};
+
+    alignas(std::max(std::size_t{CACHE_LINE_SIZE}, alignof(T))) std::array<T, N> ring_{};
+};
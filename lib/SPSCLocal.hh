@@ -1,19 +1,30 @@
 #pragma once
 
+#include "bulk_copy.hh"
+#include "cache_line.hh"
+#include "index_policy.hh"
+#include "queue_probes.hh"
+
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <cassert>
 #include <memory>
 #include <new>
 #include <iostream>
+#include <span>
+#include <thread>
+#include <type_traits>
 
-#ifdef APPLE_H
-#define CACHE_LINE_SIZE 128
-#else
-#define CACHE_LINE_SIZE 64
-#endif
-
-/// Threadsafe but flawed circular FIFO
-template<typename T, const int N = 1 << 17, typename Alloc = std::allocator<T>>
+/// Threadsafe but flawed circular FIFO.
+/// `Index` maps cursors onto ring slots (index_policy.hh): the default mask needs a
+/// power-of-two N; FastModIndex or WrapIndex allow any N. With a mirrored allocator
+/// (MirroredAllocator.hh) bulk copies and spans never split at the wrap. `Layout`
+/// (cache_line.hh) sets how far apart the cursors and cached cursors are placed. With a
+/// reclaimable allocator (ReservedAllocator.hh) the consumer can release the pages of the
+/// free part of the ring with reclaim().
+template<typename T, const int N = 1 << 17, typename Alloc = std::allocator<T>, typename Index = MaskIndex<N>,
+         typename Layout = CursorLayout<>>
 class SPSCLocal : private Alloc
 {
 public:
@@ -21,15 +32,22 @@ public:
     using allocator_traits = std::allocator_traits<Alloc>;
     using size_type = typename allocator_traits::size_type;
 
+    /// Whether the allocator can release ring pages while the queue is in use
+    static constexpr bool reclaimable = requires { requires Alloc::reclaimable; };
+
     explicit SPSCLocal(Alloc const& alloc = Alloc{})
         : Alloc{alloc}
         , capacity_{N}
         , ring_{allocator_traits::allocate(*this, N)}
-    {}
+    {
+        if constexpr (reclaimable) {
+            gate_.pageShift = static_cast<unsigned>(std::countr_zero(Alloc::pageSize() / sizeof(T)));
+        }
+    }
 
     ~SPSCLocal() {
         while(not empty()) {
-            ring_[popCursor_ & bit_mask].~T();
+            element(popCursor_, popIndex_)->~T();
             ++popCursor_;
         }
         allocator_traits::deallocate(*this, ring_, capacity_);
@@ -60,11 +78,14 @@ public:
         size_type pushCur = pushCursor_.load(std::memory_order_relaxed);
         if (full(pushCur, popLocal)) {
             popLocal = popCursor_.load(std::memory_order_acquire);
+            QUEUE_PROBE(push_refresh, this, pushCur, popLocal);
             if (full(pushCur, popLocal)) {
+                QUEUE_PROBE(push_full, this, pushCur, popLocal);
                 return false;
             }
         }
-        new (element(pushCur)) T(value);
+        enterPage(pushCur);
+        new (element(pushCur, pushIndex_)) T(value);
         pushCursor_.store(pushCur + 1, std::memory_order_release);
         return true;
     }
@@ -75,30 +96,200 @@ public:
         size_type popCur = popCursor_.load(std::memory_order_relaxed);
         if (empty(pushLocal, popCur)) {
             pushLocal = pushCursor_.load(std::memory_order_acquire);
+            QUEUE_PROBE(pop_refresh, this, popCur, pushLocal);
             if (empty(pushLocal, popCur)) {
+                QUEUE_PROBE(pop_empty, this, popCur, pushLocal);
                 return false;
             }
         }
-        value = *element(popCur);
-        element(popCur)->~T();
+        auto* slot = element(popCur, popIndex_);
+        value = *slot;
+        slot->~T();
         popCursor_.store(popCur + 1, std::memory_order_release);
         return true;
     }
 
+    /// Push up to `count` objects with bulk copies, split where the batch wraps around the
+    /// ring, and publish them with a single cursor store. Batches of at least
+    /// `streamingThreshold` bytes use non-temporal stores.
+    /// @return the number of objects pushed; less than `count` if the fifo filled up.
+    size_type pushBulk(const T* values, size_type count, std::size_t streamingThreshold = bulkStreamingThreshold)
+    requires std::is_trivially_copyable_v<T>
+    {
+        size_type pushCur = pushCursor_.load(std::memory_order_relaxed);
+        if (capacity_ - (pushCur - popLocal) < count) {
+            popLocal = popCursor_.load(std::memory_order_acquire);
+            QUEUE_PROBE(push_refresh, this, pushCur, popLocal);
+        }
+        count = std::min(count, capacity_ - (pushCur - popLocal));
+        if (count == 0) {
+            return 0;
+        }
+        enterPage(pushCur + count - 1);
+        auto* slot = element(pushCur, pushIndex_);
+        auto first = std::min(count, contiguous(slot));
+        const bool streaming = count * sizeof(T) >= streamingThreshold;
+        bulkCopyBytes(slot, values, first * sizeof(T), streaming);
+        bulkCopyBytes(ring_, values + first, (count - first) * sizeof(T), streaming);
+        pushCursor_.store(pushCur + count, std::memory_order_release);
+        QUEUE_PROBE(push_batch, this, pushCur, count);
+        return count;
+    }
+
+    /// Pop up to `count` objects into `values` with bulk copies and a single cursor store.
+    /// @return the number of objects popped; 0 if the fifo is empty.
+    size_type popBulk(T* values, size_type count, std::size_t streamingThreshold = bulkStreamingThreshold)
+    requires std::is_trivially_copyable_v<T>
+    {
+        size_type popCur = popCursor_.load(std::memory_order_relaxed);
+        if (pushLocal - popCur < count) {
+            pushLocal = pushCursor_.load(std::memory_order_acquire);
+            QUEUE_PROBE(pop_refresh, this, popCur, pushLocal);
+        }
+        count = std::min(count, static_cast<size_type>(pushLocal - popCur));
+        if (count == 0) {
+            return 0;
+        }
+        auto* slot = element(popCur, popIndex_);
+        auto first = std::min(count, contiguous(slot));
+        const bool streaming = count * sizeof(T) >= streamingThreshold;
+        bulkCopyBytes(values, slot, first * sizeof(T), streaming);
+        bulkCopyBytes(values + first, ring_, (count - first) * sizeof(T), streaming);
+        popCursor_.store(popCur + count, std::memory_order_release);
+        QUEUE_PROBE(pop_batch, this, popCur, count);
+        return count;
+    }
+
+    /// Writable slots for up to `count` objects starting at the push cursor: as many as are
+    /// free, cut at the end of the ring unless the allocator is mirrored. Fill a prefix and
+    /// publish it with commit().
+    std::span<T> prepare(size_type count = N)
+    requires std::is_trivially_copyable_v<T>
+    {
+        size_type pushCur = pushCursor_.load(std::memory_order_relaxed);
+        if (capacity_ - (pushCur - popLocal) < count) {
+            popLocal = popCursor_.load(std::memory_order_acquire);
+            QUEUE_PROBE(push_refresh, this, pushCur, popLocal);
+        }
+        auto* slot = element(pushCur, pushIndex_);
+        count = std::min({count, capacity_ - (pushCur - popLocal), contiguous(slot)});
+        if (count > 0) {
+            enterPage(pushCur + count - 1);
+        }
+        return {slot, count};
+    }
+
+    /// Publishes the first `count` objects written through the last prepare()
+    void commit(size_type count) noexcept {
+        size_type pushCur = pushCursor_.load(std::memory_order_relaxed);
+        assert(capacity_ - (pushCur - popLocal) >= count);
+        pushCursor_.store(pushCur + count, std::memory_order_release);
+        QUEUE_PROBE(push_batch, this, pushCur, count);
+    }
+
+    /// Readable objects starting `offset` objects past the pop cursor, up to `count`, cut
+    /// at the end of the ring unless the allocator is mirrored. Release them with consume().
+    /// A non-zero offset lets the consumer look past objects it has not released yet.
+    std::span<const T> peek(size_type count = N, size_type offset = 0)
+    requires std::is_trivially_copyable_v<T>
+    {
+        size_type popCur = popCursor_.load(std::memory_order_relaxed);
+        if (pushLocal - popCur < offset + count) {
+            pushLocal = pushCursor_.load(std::memory_order_acquire);
+            QUEUE_PROBE(pop_refresh, this, popCur, pushLocal);
+        }
+        auto available = static_cast<size_type>(pushLocal - popCur);
+        if (available <= offset) {
+            return {};
+        }
+        auto* slot = element(popCur + offset, popIndex_);
+        return {slot, std::min({count, available - offset, contiguous(slot)})};
+    }
+
+    /// Hands the first `count` objects of the last peek() back to the producer
+    void consume(size_type count) noexcept {
+        size_type popCur = popCursor_.load(std::memory_order_relaxed);
+        assert(pushLocal - popCur >= count);
+        popCursor_.store(popCur + count, std::memory_order_release);
+        QUEUE_PROBE(pop_batch, this, popCur, count);
+    }
+
+    /// Consumer side: releases the whole pages of the free part of the ring that the
+    /// producer has not reached yet; they fault in again when it does. Pages holding
+    /// unconsumed elements and the page the producer is writing are kept.
+    /// @return the number of bytes released.
+    std::size_t reclaim() noexcept
+    requires reclaimable
+    {
+        // Pairs with enterPage(): either the producer sees the flag and waits, or its page is read here
+        gate_.reclaiming.store(true, std::memory_order_seq_cst);
+        size_type producerPage = gate_.producerPage.load(std::memory_order_seq_cst);
+        size_type popCur = popCursor_.load(std::memory_order_relaxed);
+
+        size_type begin = (producerPage + 1) << gate_.pageShift;
+        size_type end = (popCur >> gate_.pageShift << gate_.pageShift) + capacity_;
+        std::size_t released = 0;
+        if (begin < end) {
+            auto first = begin % capacity_;
+            auto count = end - begin;
+            auto head = std::min(count, capacity_ - first);
+            this->release(ring_ + first, head);
+            if (count > head) {
+                this->release(ring_, count - head);
+            }
+            released = count * sizeof(T);
+        }
+        gate_.reclaiming.store(false, std::memory_order_seq_cst);
+        return released;
+    }
+
+    /// Bytes of the ring currently backed by memory
+    std::size_t residentBytes() const
+    requires reclaimable
+    {
+        return Alloc::residentBytes(ring_, capacity_);
+    }
+
 private:
+    static constexpr bool mirrored = requires { requires Alloc::mirrored; };
+
+    /// Slots that can be addressed contiguously from `slot`
+    inline size_type contiguous(const T* slot) const noexcept {
+        if constexpr (mirrored) {
+            return capacity_;
+        } else {
+            return static_cast<size_type>(ring_ + capacity_ - slot);
+        }
+    }
+
     inline auto full(size_type pushCursor, size_type popCursor) const noexcept {
         return (pushCursor - popCursor) == capacity_;
     }
     inline bool empty(size_type pushCursor, size_type popCursor) const noexcept {
         return pushCursor == popCursor;
     }
-    inline auto element(size_type cursor) const noexcept {
-        return &ring_[cursor & bit_mask];
+    inline T* element(size_type cursor, Index& index) const noexcept {
+        return &ring_[index(cursor)];
+    }
+
+    /// Producer side: announces the page of `cursor` before the first write to it, and
+    /// waits while the consumer is releasing pages
+    inline void enterPage(size_type cursor) noexcept {
+        if constexpr (reclaimable) {
+            size_type page = cursor >> gate_.pageShift;
+            if (page > gate_.cachedPage) [[unlikely]] {
+                gate_.cachedPage = page;
+                gate_.producerPage.store(page, std::memory_order_seq_cst);
+                while (gate_.reclaiming.load(std::memory_order_seq_cst)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
     }
 
 private:
 
-    static constexpr int bit_mask = N - 1; 
+    static_assert(Index::capacity == std::size_t(N), "index policy capacity must match N");
 
     using CursorType = std::atomic<size_type>;
     static_assert(CursorType::is_always_lock_free);
@@ -107,19 +298,43 @@ private:
     T* ring_;
 
     /// Loaded and stored by the push thread; loaded by the pop thread
-    alignas(CACHE_LINE_SIZE) CursorType pushCursor_;
+    alignas(std::max(Layout::separation, alignof(CursorType))) CursorType pushCursor_;
 
-    alignas(CACHE_LINE_SIZE) size_type popLocal{};
+    alignas(std::max(Layout::cachedAlignment, alignof(size_type))) size_type popLocal{};
+
+    /// Producer's cursor to slot mapping
+    [[no_unique_address]] Index pushIndex_{};
 
     // char push_padding[128 - sizeof(CursorType)];
     
     /// Loaded and stored by the pop thread; loaded by the push thread
-    alignas(CACHE_LINE_SIZE) CursorType popCursor_;
+    alignas(std::max(Layout::separation, alignof(CursorType))) CursorType popCursor_;
+
+    alignas(std::max(Layout::cachedAlignment, alignof(size_type))) size_type pushLocal{};
 
-    alignas(CACHE_LINE_SIZE) size_type pushLocal{};
+    /// Consumer's cursor to slot mapping
+    [[no_unique_address]] Index popIndex_{};
 
     // char pop_padding[128 - sizeof(CursorType)];
 
-    char padding_[CACHE_LINE_SIZE - sizeof(size_type)];
+    /// Bytes of the last group: the consumer's cached cursor and index, plus its cursor when grouped
+    static constexpr std::size_t tailBytes = sizeof(size_type) + (std::is_empty_v<Index> ? 0 : sizeof(Index)) +
+        (Layout::grouping == CursorGrouping::ByWriter ? sizeof(CursorType) : 0);
+
+    char padding_[Layout::separation > tailBytes ? Layout::separation - tailBytes : 1];
+
+    /// Page handshake for reclaimable allocators: the producer announces the highest page
+    /// it may write, and reclaim() only releases pages past it
+    struct ReclaimGate {
+        alignas(cacheLineSize) std::atomic<size_type> producerPage{0};
+        /// Producer only
+        size_type cachedPage = 0;
+        unsigned pageShift = 0;
+        /// Written by the pop thread
+        alignas(cacheLineSize) std::atomic<bool> reclaiming{false};
+    };
+    struct NoReclaimGate {};
+
+    [[no_unique_address]] std::conditional_t<reclaimable, ReclaimGate, NoReclaimGate> gate_;
 
 };
\ No newline at end of file
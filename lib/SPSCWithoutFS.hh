@@ -1,17 +1,13 @@
 #pragma once
 
+#include "cache_line.hh"
+
 #include <atomic>
 #include <cassert>
 #include <memory>
 #include <new>
 #include <iostream>
 
-#ifdef APPLE_H
-#define CACHE_LINE_SIZE 128
-#else
-#define CACHE_LINE_SIZE 64
-#endif
-
 
 template<typename T, const int N = 1 << 17, typename Alloc = std::allocator<T>>
 class SPSCWithoutFS : private Alloc
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/// Storage for a trivially copyable T as an array of relaxed-order-safe atomic words, so a
+/// seqlock reader racing the writer reads stale or torn words instead of causing a data race.
+/// Stores are release and loads acquire: a reader that sees any word of a newer write also
+/// sees the odd sequence that preceded it, which keeps both sides free of standalone fences
+/// (and costs nothing on x86).
+template<typename T>
+class SeqlockWords
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    void store(const T& value) noexcept {
+        std::array<std::uint64_t, words> buffer{};
+        std::memcpy(buffer.data(), &value, sizeof(T));
+        for (std::size_t i = 0; i < words; ++i) {
+            words_[i].store(buffer[i], std::memory_order_release);
+        }
+    }
+
+    void load(T& value) const noexcept {
+        std::array<std::uint64_t, words> buffer;
+        for (std::size_t i = 0; i < words; ++i) {
+            buffer[i] = words_[i].load(std::memory_order_acquire);
+        }
+        std::memcpy(&value, buffer.data(), sizeof(T));
+    }
+
+private:
+    static constexpr std::size_t words = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    std::array<std::atomic<std::uint64_t>, words> words_{};
+};
+
+/// One value with a single writer and any number of readers. The writer never waits;
+/// readers retry while a write is in progress or completed under them.
+template<typename T>
+class Seqlock
+{
+public:
+    /// Publish a new value; single writer only
+    void store(const T& value) noexcept {
+        auto sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        value_.store(value);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /// Read a consistent copy without retrying.
+    /// @return `true` if `value` holds a whole write; `false` if a write interfered.
+    bool tryLoad(T& value) const noexcept {
+        auto before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        value_.load(value);
+        return sequence_.load(std::memory_order_relaxed) == before;
+    }
+
+    /// Read a consistent copy, spinning while the writer is active
+    void load(T& value) const noexcept {
+        while (not tryLoad(value)) {
+            ;
+        }
+    }
+
+    /// Number of completed writes
+    std::uint64_t version() const noexcept { return sequence_.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<std::uint64_t> sequence_{0};
+    SeqlockWords<T> value_;
+};
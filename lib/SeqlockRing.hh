@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Seqlock.hh"
+#include "cache_line.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// Lossy broadcast ring: one producer that never blocks and always overwrites the oldest
+/// slot, and any number of independent readers. Message i goes to slot i % N, whose sequence
+/// is 2i+1 while it is written and 2i+2 once complete, so a reader can tell a slot that is
+/// not yet written, being written, or already overwritten by a later lap. Readers never
+/// write shared memory, so they put no cache traffic on the producer.
+template<typename T, const int N = 1 << 12>
+class SeqlockRing
+{
+    struct Slot;
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static_assert(N > 1 and (N & (N - 1)) == 0, "capacity must be a power of two");
+
+    /// Independent cursor into the ring; owned by one reader thread
+    class Reader
+    {
+    public:
+        /// Read the next message.
+        /// @return `true` if `value` holds the next message; `false` if the reader is caught up.
+        /// When the producer lapped the reader, the overwritten messages are skipped and
+        /// counted in lost().
+        bool read(T& value) noexcept {
+            while (true) {
+                const auto& slot = ring_->slot(cursor_);
+                const auto expected = 2 * cursor_ + 2;
+                auto before = slot.sequence.load(std::memory_order_acquire);
+                if (before < expected) {
+                    // Not written yet, or the producer is writing it right now
+                    return false;
+                }
+                if (before == expected) {
+                    slot.data.load(value);
+                    if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                        ++cursor_;
+                        return true;
+                    }
+                }
+                resync();
+            }
+        }
+
+        /// Total number of messages skipped because they were overwritten before being read
+        std::uint64_t lost() const noexcept { return lost_; }
+
+        /// Index of the next message this reader will return
+        std::uint64_t position() const noexcept { return cursor_; }
+
+    private:
+        friend class SeqlockRing;
+
+        Reader(const SeqlockRing* ring, std::uint64_t cursor) noexcept
+            : ring_{ring}
+            , cursor_{cursor}
+        {}
+
+        /// Jumps to the oldest message that may still be intact; the slot after the
+        /// producer's head may already be under rewrite, so that one is skipped as well
+        void resync() noexcept {
+            auto head = ring_->head_.load(std::memory_order_acquire);
+            auto oldest = head >= N ? head - N + 1 : 0;
+            if (oldest > cursor_) {
+                lost_ += oldest - cursor_;
+                cursor_ = oldest;
+            } else {
+                // Lapped by a message published after head was read; skip the overwritten one
+                ++lost_;
+                ++cursor_;
+            }
+        }
+
+        const SeqlockRing* ring_;
+        std::uint64_t cursor_;
+        std::uint64_t lost_{0};
+    };
+
+    SeqlockRing()
+        : slots_{new Slot[N]}
+    {}
+
+    SeqlockRing(SeqlockRing const&) = delete;
+    SeqlockRing& operator=(SeqlockRing const&) = delete;
+
+    /// Returns the number of slots
+    size_type capacity() const noexcept { return N; }
+
+    /// Returns the number of messages published so far
+    std::uint64_t published() const noexcept { return head_.load(std::memory_order_acquire); }
+
+    /// Publish one message, overwriting the oldest one if the ring is full; never fails
+    /// and never waits for readers. Single producer only.
+    void push(const T& value) noexcept {
+        auto& slot = slots_[pushCursor_ & bit_mask];
+        slot.sequence.store(2 * pushCursor_ + 1, std::memory_order_relaxed);
+        slot.data.store(value);
+        slot.sequence.store(2 * pushCursor_ + 2, std::memory_order_release);
+        head_.store(++pushCursor_, std::memory_order_release);
+    }
+
+    /// Reader starting with the next message to be published
+    Reader reader() const noexcept { return Reader{this, published()}; }
+
+    /// Reader starting with the oldest message still in the ring
+    Reader readerFromOldest() const noexcept {
+        auto head = published();
+        return Reader{this, head >= N ? head - N + 1 : 0};
+    }
+
+private:
+    static constexpr std::uint64_t bit_mask = N - 1;
+
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        SeqlockWords<T> data;
+    };
+
+    const Slot& slot(std::uint64_t index) const noexcept { return slots_[index & bit_mask]; }
+
+    std::unique_ptr<Slot[]> slots_;
+
+    /// Producer local
+    alignas(CACHE_LINE_SIZE) std::uint64_t pushCursor_{0};
+
+    /// Published message count, read by readers only when they resynchronise
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> head_{0};
+
+    char padding_[CACHE_LINE_SIZE - sizeof(std::atomic<std::uint64_t>)];
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "cache_line.hh"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/// Chase-Lev work-stealing deque (with the orderings of Le et al., "Correct and Efficient
+/// Work-Stealing for Weak Memory Models"). The owner thread pushes and pops at the bottom,
+/// any number of thieves steal from the top. The ring doubles when full; retired rings stay
+/// alive until destruction because a thief may still be reading from one.
+/// Elements live in atomics, so T must be trivially copyable and lock free (typically a pointer).
+/// The fences of the paper are folded into seq_cst operations on the cursors.
+template<typename T, const int N = 1 << 10>
+class WorkStealingDeque
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(std::atomic<T>::is_always_lock_free);
+    static_assert(N > 1 and (N & (N - 1)) == 0, "initial capacity must be a power of two");
+
+    WorkStealingDeque() {
+        rings_.push_back(std::make_unique<Ring>(N));
+        ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(WorkStealingDeque const&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque const&) = delete;
+
+    /// Returns the number of elements; exact only while no thread operates on the deque
+    size_type size() const noexcept {
+        auto bottom = bottom_.load(std::memory_order_relaxed);
+        auto top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_type>(bottom - top) : 0;
+    }
+
+    /// Returns whether the container has no elements
+    bool empty() const noexcept { return size() == 0; }
+
+    /// Returns the number of elements the current ring holds before growing (owner only)
+    size_type capacity() const noexcept { return ring_.load(std::memory_order_relaxed)->capacity(); }
+
+    /// Push one object at the bottom; owner only. Never fails, the ring grows instead.
+    void push(const T& value) {
+        auto bottom = bottom_.load(std::memory_order_relaxed);
+        auto top = top_.load(std::memory_order_acquire);
+        auto* ring = ring_.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<std::int64_t>(ring->capacity()) - 1) {
+            ring = grow(ring, top, bottom);
+        }
+        ring->put(bottom, value);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    /// Pop the most recently pushed object; owner only.
+    /// @return `true` if the pop operation is successful; `false` if the deque is empty.
+    bool pop(T& value) {
+        auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        auto* ring = ring_.load(std::memory_order_relaxed);
+        // Reserve the bottom slot before looking at top, so a concurrent thief either sees
+        // the reservation or is seen by us
+        bottom_.store(bottom, std::memory_order_seq_cst);
+        auto top = top_.load(std::memory_order_seq_cst);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        value = ring->get(bottom);
+        if (top == bottom) {
+            // Last element: race the thieves for it
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /// Steal the oldest object; safe to call from any thread.
+    /// @return `true` if the steal is successful; `false` if the deque is empty or another
+    /// thread took the element first.
+    bool steal(T& value) {
+        auto top = top_.load(std::memory_order_seq_cst);
+        auto bottom = bottom_.load(std::memory_order_seq_cst);
+        if (top >= bottom) {
+            return false;
+        }
+        auto* ring = ring_.load(std::memory_order_acquire);
+        value = ring->get(top);
+        return top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    }
+
+private:
+    class Ring
+    {
+    public:
+        explicit Ring(size_type capacity)
+            : mask_{capacity - 1}
+            , slots_{new std::atomic<T>[capacity]}
+        {}
+
+        size_type capacity() const noexcept { return mask_ + 1; }
+
+        T get(std::int64_t index) const noexcept {
+            return slots_[static_cast<size_type>(index) & mask_].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t index, const T& value) noexcept {
+            slots_[static_cast<size_type>(index) & mask_].store(value, std::memory_order_relaxed);
+        }
+
+    private:
+        size_type mask_;
+        std::unique_ptr<std::atomic<T>[]> slots_;
+    };
+
+    Ring* grow(Ring* ring, std::int64_t top, std::int64_t bottom) {
+        auto bigger = std::make_unique<Ring>(ring->capacity() * 2);
+        for (auto i = top; i < bottom; ++i) {
+            bigger->put(i, ring->get(i));
+        }
+        rings_.push_back(std::move(bigger));
+        ring = rings_.back().get();
+        ring_.store(ring, std::memory_order_release);
+        return ring;
+    }
+
+    using CursorType = std::atomic<std::int64_t>;
+    static_assert(CursorType::is_always_lock_free);
+
+    /// Every ring ever used, newest last; owner only
+    std::vector<std::unique_ptr<Ring>> rings_;
+
+    /// Written by the owner, read by thieves
+    alignas(CACHE_LINE_SIZE) std::atomic<Ring*> ring_{nullptr};
+    CursorType bottom_{0};
+
+    /// Advanced by thieves, and by the owner when it takes the last element
+    alignas(CACHE_LINE_SIZE) CursorType top_{0};
+
+    char padding_[CACHE_LINE_SIZE - sizeof(CursorType)];
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "BoundedMPMC.hh"
+#include "WorkStealingDeque.hh"
+#include "thread_utils.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/// Unit of work run by a pool; owned by the submitter, which must keep it alive until it ran
+struct Task
+{
+    virtual ~Task() = default;
+    virtual void execute() = 0;
+};
+
+/// Minimal work-stealing thread pool. Every worker owns a WorkStealingDeque: tasks submitted
+/// from a worker go to the bottom of its own deque and are popped back LIFO, idle workers
+/// steal FIFO from the top of a random victim. Tasks submitted from other threads go
+/// through a shared injection queue.
+class WorkStealingPool
+{
+public:
+    /// Starts `workers` threads; worker k is pinned to cpus[k] when given
+    explicit WorkStealingPool(std::size_t workers, std::vector<int> cpus = {})
+        : count_{workers}
+        , workers_{new Worker[workers]}
+    {
+        threads_.reserve(workers);
+        for (auto k = std::size_t{}; k < workers; ++k) {
+            auto cpu = k < cpus.size() ? cpus[k] : -1;
+            threads_.emplace_back([this, k, cpu] { run(k, cpu); });
+        }
+    }
+
+    WorkStealingPool(WorkStealingPool const&) = delete;
+    WorkStealingPool& operator=(WorkStealingPool const&) = delete;
+
+    ~WorkStealingPool() { stop(); }
+
+    /// Returns the number of worker threads
+    std::size_t workers() const noexcept { return count_; }
+
+    /// Index of the calling worker of this pool, or -1 on any other thread
+    int workerIndex() const noexcept { return current_.pool == this ? static_cast<int>(current_.index) : -1; }
+
+    /// Schedule `task`; spins while the injection queue is full.
+    void submit(Task* task) {
+        if (current_.pool == this) {
+            workers_[current_.index].deque.push(task);
+            return;
+        }
+        while (not injection_.push(task)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /// Joins the workers; tasks not yet started are dropped.
+    void stop() {
+        stop_.store(true, std::memory_order_relaxed);
+        for (auto& th : threads_) {
+            if (th.joinable()) {
+                th.join();
+            }
+        }
+    }
+
+private:
+    /// Idle rounds spent spinning before yielding the cpu
+    static constexpr unsigned spinLimit = 64;
+
+    struct alignas(CACHE_LINE_SIZE) Worker {
+        WorkStealingDeque<Task*> deque;
+    };
+
+    /// Zero-initialized like any thread_local, i.e. no pool
+    struct Current {
+        WorkStealingPool* pool;
+        std::size_t index;
+    };
+
+    void run(std::size_t self, int cpu) {
+        pinThread(cpu);
+        current_ = Current{this, self};
+        auto& own = workers_[self].deque;
+        // xorshift state for victim selection, distinct per worker
+        auto seed = static_cast<std::uint32_t>(self * 2654435761u + 1);
+        Task* task;
+        unsigned idle = 0;
+
+        while (not stop_.load(std::memory_order_relaxed)) {
+            if (own.pop(task) or injection_.pop(task) or steal(self, seed, task)) {
+                task->execute();
+                idle = 0;
+            } else if (++idle > spinLimit) {
+                std::this_thread::yield();
+            }
+        }
+        current_ = Current{};
+    }
+
+    /// Tries every other worker once, starting at a random victim
+    bool steal(std::size_t self, std::uint32_t& seed, Task*& task) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        auto start = seed % count_;
+        for (auto n = std::size_t{}; n < count_; ++n) {
+            auto victim = (start + n) % count_;
+            if (victim != self and workers_[victim].deque.steal(task)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::size_t count_;
+    std::unique_ptr<Worker[]> workers_;
+    std::vector<std::thread> threads_;
+
+    /// Tasks submitted from outside the pool
+    BoundedMPMC<Task*, 1 << 12> injection_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> stop_{false};
+
+    inline static thread_local Current current_;
+};
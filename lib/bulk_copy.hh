@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BULK_COPY_X86 1
+#include <immintrin.h>
+#endif
+
+/// Copies at least this large bypass the cache with non-temporal stores by default; about
+/// half a typical L2, beyond which the destination would evict the working set anyway
+inline constexpr std::size_t bulkStreamingThreshold = std::size_t{512} << 10;
+
+namespace bulk_detail {
+
+#if defined(BULK_COPY_X86)
+
+// The kernels carry their instruction set as a target attribute rather than relying on
+// -march, so they build everywhere and the tests can run each one the CPU supports.
+// bulkCopyBytes still only calls the widest one the translation unit was compiled for.
+
+namespace avx2 {
+
+inline constexpr std::size_t vectorBytes = 32;
+
+/// Unaligned vector loads and stores, four vectors per iteration
+__attribute__((target("avx2")))
+inline void copyVectors(std::byte* dst, const std::byte* src, std::size_t bytes) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 * vectorBytes <= bytes; i += 4 * vectorBytes) {
+        auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+        auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64));
+        auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), a);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 64), c);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 96), d);
+    }
+    for (; i + vectorBytes <= bytes; i += vectorBytes) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    }
+    std::memcpy(dst + i, src + i, bytes - i);
+}
+
+/// Non-temporal stores to a vector-aligned destination; the head up to the first aligned
+/// address and the tail go through the cache
+__attribute__((target("avx2")))
+inline void streamVectors(std::byte* dst, const std::byte* src, std::size_t bytes) noexcept {
+    auto misalignment = reinterpret_cast<std::uintptr_t>(dst) & (vectorBytes - 1);
+    std::size_t head = misalignment ? vectorBytes - misalignment : 0;
+    if (head >= bytes) {
+        std::memcpy(dst, src, bytes);
+        return;
+    }
+    std::memcpy(dst, src, head);
+    std::size_t i = head;
+    for (; i + vectorBytes <= bytes; i += vectorBytes) {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    }
+    std::memcpy(dst + i, src + i, bytes - i);
+    // Streaming stores are weakly ordered: drain them before the caller publishes a cursor
+    _mm_sfence();
+}
+
+}  // namespace avx2
+
+namespace avx512 {
+
+inline constexpr std::size_t vectorBytes = 64;
+
+/// Unaligned vector loads and stores, four vectors per iteration
+__attribute__((target("avx512f")))
+inline void copyVectors(std::byte* dst, const std::byte* src, std::size_t bytes) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 * vectorBytes <= bytes; i += 4 * vectorBytes) {
+        auto a = _mm512_loadu_si512(src + i);
+        auto b = _mm512_loadu_si512(src + i + 64);
+        auto c = _mm512_loadu_si512(src + i + 128);
+        auto d = _mm512_loadu_si512(src + i + 192);
+        _mm512_storeu_si512(dst + i, a);
+        _mm512_storeu_si512(dst + i + 64, b);
+        _mm512_storeu_si512(dst + i + 128, c);
+        _mm512_storeu_si512(dst + i + 192, d);
+    }
+    for (; i + vectorBytes <= bytes; i += vectorBytes) {
+        _mm512_storeu_si512(dst + i, _mm512_loadu_si512(src + i));
+    }
+    std::memcpy(dst + i, src + i, bytes - i);
+}
+
+/// Non-temporal stores to a vector-aligned destination; the head up to the first aligned
+/// address and the tail go through the cache
+__attribute__((target("avx512f")))
+inline void streamVectors(std::byte* dst, const std::byte* src, std::size_t bytes) noexcept {
+    auto misalignment = reinterpret_cast<std::uintptr_t>(dst) & (vectorBytes - 1);
+    std::size_t head = misalignment ? vectorBytes - misalignment : 0;
+    if (head >= bytes) {
+        std::memcpy(dst, src, bytes);
+        return;
+    }
+    std::memcpy(dst, src, head);
+    std::size_t i = head;
+    for (; i + vectorBytes <= bytes; i += vectorBytes) {
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(dst + i), _mm512_loadu_si512(src + i));
+    }
+    std::memcpy(dst + i, src + i, bytes - i);
+    _mm_sfence();
+}
+
+}  // namespace avx512
+
+#endif
+
+#if defined(__AVX512F__)
+namespace native = avx512;
+#elif defined(__AVX2__)
+namespace native = avx2;
+#endif
+
+}  // namespace bulk_detail
+
+/// Copies `bytes` from `src` to `dst` (non-overlapping) with the widest vectors the target
+/// was compiled for (-march=native in Release), or memcpy without AVX2. With `streaming`
+/// the stores are non-temporal and fenced, so a following release store orders after them.
+inline void bulkCopyBytes(void* dst, const void* src, std::size_t bytes, bool streaming = false) noexcept {
+#if defined(__AVX512F__) || defined(__AVX2__)
+    auto* d = static_cast<std::byte*>(dst);
+    auto* s = static_cast<const std::byte*>(src);
+    if (streaming) {
+        bulk_detail::native::streamVectors(d, s, bytes);
+    } else {
+        bulk_detail::native::copyVectors(d, s, bytes);
+    }
+#else
+    (void)streaming;
+    std::memcpy(dst, src, bytes);
+#endif
+}
+
+/// Copies `count` trivially copyable elements, streaming once the batch reaches `streamingThreshold` bytes
+template<typename T>
+inline void bulkCopy(T* dst, const T* src, std::size_t count,
+                     std::size_t streamingThreshold = bulkStreamingThreshold) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>);
+    auto bytes = count * sizeof(T);
+    bulkCopyBytes(dst, src, bytes, bytes >= streamingThreshold);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/// Coherence granularity used to keep data written by different threads apart.
+/// In order of preference:
+/// - QUEUE_CACHE_LINE_SIZE, which CMake sets from sysfs coherency_line_size at configure
+///   time, or from -DQUEUE_CACHE_LINE_SIZE=N on the command line
+/// - 128 on Apple silicon (APPLE_H)
+/// - std::hardware_destructive_interference_size where the standard library has it
+/// - 64
+#if defined(QUEUE_CACHE_LINE_SIZE)
+inline constexpr std::size_t cacheLineSize = QUEUE_CACHE_LINE_SIZE;
+#elif defined(APPLE_H)
+inline constexpr std::size_t cacheLineSize = 128;
+#elif defined(__cpp_lib_hardware_interference_size)
+// GCC warns that the value may differ between -mtune targets, which is the point here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+inline constexpr std::size_t cacheLineSize = std::hardware_destructive_interference_size;
+#pragma GCC diagnostic pop
+#else
+inline constexpr std::size_t cacheLineSize = 64;
+#endif
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE cacheLineSize
+#endif
+
+static_assert(cacheLineSize >= alignof(std::max_align_t) and (cacheLineSize & (cacheLineSize - 1)) == 0);
+
+/// Whether a queue's cached copy of the other side's cursor gets its own block
+/// (Separate) or shares the block of the cursor its thread publishes (ByWriter)
+enum class CursorGrouping { Separate, ByWriter };
+
+/// Placement of the hot fields of a queue: every group starts `Separation` bytes apart,
+/// and 0 packs the fields at their natural alignment
+template<std::size_t Separation = cacheLineSize, CursorGrouping Grouping = CursorGrouping::Separate>
+struct CursorLayout {
+    static_assert((Separation & (Separation - 1)) == 0, "separation must be 0 or a power of two");
+
+    static constexpr std::size_t separation = Separation;
+    static constexpr CursorGrouping grouping = Grouping;
+    /// Alignment of the cached cursors: a group of their own, or packed behind their writer's cursor
+    static constexpr std::size_t cachedAlignment = Grouping == CursorGrouping::Separate ? Separation : 0;
+};
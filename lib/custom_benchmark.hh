@@ -1,135 +1,102 @@
-#include <benchmark/benchmark.h>
+#pragma once
 
-#include <iostream>
-#include <iomanip>
+#include "queue_adapter.hh"
+#include "thread_utils.hh"
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
 #include <thread>
 #include <type_traits>
-#include <vector>
-// MAC OS specific 
-#ifdef APPLE_H
-#include <sys/sysctl.h>
-#include <Kernel/mach/thread_act.h>
-#include <Kernel/mach/thread_policy.h>
-#endif
 
 template<typename T>
 inline __attribute__((always_inline)) void doNotOptimize(T const& value) {
     asm volatile("" : : "r,m" (value) : "memory");
 }
 
-// [SFINAE] default template for rigtorp to evaluate to false
-template<typename T>
-struct is_rigtorp : std::false_type {};
+/// Per-run settings; a negative cpu leaves that thread unpinned
+struct BenchOptions {
+    std::size_t capacity = 1 << 17;
+    int producerCpu = -1;
+    int consumerCpu = -1;
+};
 
+/// One producer/consumer throughput measurement. The queue is filled and drained once
+/// (capacity() elements) to fault in the ring before `iterations` sequence numbers are
+/// pushed and checked on the consumer side; the clock covers the producer until the
+/// queue is empty again. Queues sized at runtime are built with `options.capacity`,
+/// the others keep their template capacity.
 template<typename T>
 class Bench {
-    T fifo;
+    std::unique_ptr<T> fifo_;
+    BenchOptions options_;
     using queue_value_type = typename T::value_type;
-    // static constexpr bool is_rig = is_rigtorp<T>::value;
-
-    public:
 
-    auto operator()(int64_t iterations) {
-        
-        // Currently no support for jthread in clang 17
-        auto th = std::thread([&] {
-        // pop warmup
-            for (auto i = queue_value_type{}; i < fifo.capacity(); ++i) {
-                queue_value_type val;
-                if constexpr (is_rigtorp<T>::value) {
-                    while (auto again = not fifo.front()) {
-                        doNotOptimize(again);
-	                }
-                    val = *fifo.front();
-                    fifo.pop();
-                } else {
-                    while (auto again = not fifo.pop(val)) {
-                        doNotOptimize(again);
-                    }
-                    doNotOptimize(val);
-                }
-
-                if (val != i) {
-                    std::cout << "Errrrr::::   " << val << " " << i << std::endl;
-                    throw std::runtime_error("invalid value");
-                }
+    static std::unique_ptr<T> make(std::size_t capacity) {
+        if constexpr (std::is_constructible_v<T, std::size_t>) {
+            return std::make_unique<T>(capacity);
+        } else {
+            return std::make_unique<T>();
+        }
+    }
 
+    void popSequence(std::int64_t count) {
+        for (auto i = queue_value_type{}; i < count; ++i) {
+            queue_value_type val;
+            while (auto again = not tryPop(*fifo_, val)) {
+                doNotOptimize(again);
             }
-
-            // pop benchmark run
-            for (auto i = queue_value_type{}; i < iterations; ++i) {
-                queue_value_type val;
-                if constexpr (is_rigtorp<T>::value) {
-                    while (auto again = not fifo.front()) {
-                        doNotOptimize(again);
-	                }
-                    val = *fifo.front();
-                    fifo.pop();
-                } else {
-                    while (auto again = not fifo.pop(val)) {
-                        doNotOptimize(again);
-                    }
-                    doNotOptimize(val);
-                }
-                if (val != i) {
-                    throw std::runtime_error("invalid value");
-                }
+            doNotOptimize(val);
+            if (val != i) {
+                throw std::runtime_error("invalid value");
             }
-        });
+        }
+    }
 
-        // push warmup
-        for (auto i = queue_value_type{}; i < fifo.capacity(); ++i) {
-            if constexpr (is_rigtorp<T>::value) {
-                while (auto again = not fifo.try_push(i)) {
-                    doNotOptimize(again);
-                }
-            } else {
-                while (auto again = not fifo.push(i)) {
-                    doNotOptimize(again);
-                }
+    void pushSequence(std::int64_t count) {
+        for (auto i = queue_value_type{}; i < count; ++i) {
+            while (auto again = not tryPush(*fifo_, i)) {
+                doNotOptimize(again);
             }
         }
+    }
 
-        while (auto again = not fifo.empty()) {
+    void waitEmpty() {
+        while (auto again = not queueEmpty(*fifo_)) {
             doNotOptimize(again);
         }
+    }
 
-    assert(fifo.empty());
-
-    auto start = std::chrono::high_resolution_clock::now();
-        // push test
-        for (auto i = queue_value_type{}; i < iterations; ++i) {
-            if constexpr (is_rigtorp<T>::value) {
-                while (auto again = not fifo.try_push(i)) {
-                    doNotOptimize(again);
-                }
-            } else {
-                while (auto again = not fifo.push(i)) {
-                    doNotOptimize(again);
-                }
-            }
-        }
+    public:
 
-        while (auto again = not fifo.empty()) {
-            doNotOptimize(again);
-        }
-    auto end = std::chrono::high_resolution_clock::now();
+    explicit Bench(BenchOptions options = {}) : fifo_{make(options.capacity)}, options_{options} {}
+
+    /// @return elements per second
+    double operator()(std::int64_t iterations) {
+        std::int64_t warmup = static_cast<std::int64_t>(queueCapacity(*fifo_));
+
+        // Currently no support for jthread in clang 17
+        auto th = std::thread([&] {
+            pinThread(options_.consumerCpu);
+            popSequence(warmup);
+            popSequence(iterations);
+        });
+        pinThread(options_.producerCpu);
+
+        pushSequence(warmup);
+        waitEmpty();
+        assert(queueEmpty(*fifo_));
+
+        auto start = std::chrono::steady_clock::now();
+        pushSequence(iterations);
+        waitEmpty();
+        auto end = std::chrono::steady_clock::now();
 
         th.join();
-        
+
         return (iterations / std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
     }
 };
-
-
-template<class T>
-void bench() {   
-    constexpr auto iters = 400'000'000l;
-    // constexpr auto iters = 100'000'000l;
-
-    auto opsPerSec = Bench<T>{}(iters);
-    std::cout << std::fixed << std::showpoint;
-    std::cout << std::setprecision(10);
-    std::cout << std::setw(7) << std::left << "SPSCFifo: "
-        << std::setw(10) << std::right << opsPerSec << " ops/s\n";
-}
\ No newline at end of file
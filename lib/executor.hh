@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+
+/// Minimal executor that resumes posted coroutines on the thread calling run().
+/// post() may be called from any thread; it is only used on the slow path of the
+/// async queues, so a mutex protected deque is good enough.
+class SingleThreadExecutor
+{
+public:
+    SingleThreadExecutor() = default;
+    SingleThreadExecutor(SingleThreadExecutor const&) = delete;
+    SingleThreadExecutor& operator=(SingleThreadExecutor const&) = delete;
+
+    /// Queue `handle` to be resumed by the thread running this executor.
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard lock{mutex_};
+            ready_.push_back(handle);
+        }
+        cv_.notify_one();
+    }
+
+    /// Resume posted coroutines until stop() is called and nothing is left to run.
+    void run() {
+        std::unique_lock lock{mutex_};
+        while (true) {
+            cv_.wait(lock, [this] { return stopped_ or not ready_.empty(); });
+            if (ready_.empty()) {
+                return;
+            }
+            auto handle = ready_.front();
+            ready_.pop_front();
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+        }
+    }
+
+    /// Resume every coroutine posted so far without blocking.
+    /// @return the number of coroutines resumed.
+    std::size_t poll() {
+        std::deque<std::coroutine_handle<>> batch;
+        {
+            std::lock_guard lock{mutex_};
+            batch.swap(ready_);
+        }
+        for (auto handle : batch) {
+            handle.resume();
+        }
+        return batch.size();
+    }
+
+    /// Make run() return once the ready queue has drained.
+    void stop() {
+        {
+            std::lock_guard lock{mutex_};
+            stopped_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    /// Awaitable that moves the awaiting coroutine onto this executor.
+    auto schedule() noexcept {
+        struct Awaiter {
+            SingleThreadExecutor& executor;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::coroutine_handle<>> ready_;
+    bool stopped_{false};
+};
+
+/// Fire-and-forget coroutine type; the frame is destroyed when the body returns.
+struct DetachedTask
+{
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
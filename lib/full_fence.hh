@@ -0,0 +1,19 @@
+#pragma once
+
+#include <atomic>
+
+/// Sequentially consistent fence for Dekker-style handshakes: orders the store before it
+/// against the load after it, so of two threads that each store a flag and then read the
+/// other's, at least one sees the other's store. TSan does not model standalone fences and
+/// warns about them; the handshakes using this have no plain data behind them to check.
+inline void fullFence() noexcept {
+#if defined(__SANITIZE_THREAD__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wtsan"
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#if defined(__SANITIZE_THREAD__)
+#pragma GCC diagnostic pop
+#endif
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "require.hh"
+
+#include <cstddef>
+#include <cstdint>
+
+/// Index policies map a monotonically increasing cursor onto a slot in [0, N). A queue
+/// keeps one instance per side and calls it from that side only, so a policy may cache
+/// state between calls. Cursors are 64 bits wide: with a capacity that is not a power of
+/// two the mapping would jump once a cursor wraps past 2^64, which takes centuries.
+
+/// `cursor & (N - 1)`; only available for power-of-two capacities
+template<std::size_t N>
+requires power_of_two<N>
+struct MaskIndex {
+    static constexpr std::size_t capacity = N;
+
+    std::size_t operator()(std::size_t cursor) const noexcept { return cursor & bit_mask_of<N>; }
+};
+
+/// Plain `cursor % N`; the compiler strength-reduces the constant divisor
+template<std::size_t N>
+struct ModuloIndex {
+    static_assert(N > 0);
+    static constexpr std::size_t capacity = N;
+
+    std::size_t operator()(std::size_t cursor) const noexcept { return cursor % N; }
+};
+
+/// Lemire's fastmod: one 128-bit multiply by the precomputed reciprocal gives the
+/// fractional part of cursor / N, and a second multiply by N scales it back to the
+/// remainder. Exact for every 64-bit cursor.
+template<std::size_t N>
+struct FastModIndex {
+    static_assert(N > 0);
+    static constexpr std::size_t capacity = N;
+
+    std::size_t operator()(std::size_t cursor) const noexcept {
+        __uint128_t fraction = reciprocal * cursor;
+        __uint128_t low = static_cast<std::uint64_t>(fraction) * __uint128_t{N};
+        __uint128_t high = (fraction >> 64) * N;
+        return static_cast<std::size_t>((high + (low >> 64)) >> 64);
+    }
+
+private:
+    static constexpr __uint128_t reciprocal = ~__uint128_t{} / N + 1;
+};
+
+/// Keeps the last cursor and its slot and advances the slot with a compare and
+/// conditional reset, the way a hand-written ring index would; any other cursor falls
+/// back to `%`.
+template<std::size_t N>
+struct WrapIndex {
+    static_assert(N > 0);
+    static constexpr std::size_t capacity = N;
+
+    std::size_t operator()(std::size_t cursor) noexcept {
+        if (cursor == cursor_ + 1) {
+            slot_ = slot_ + 1 == N ? 0 : slot_ + 1;
+        } else if (cursor != cursor_) {
+            slot_ = cursor % N;
+        }
+        cursor_ = cursor;
+        return slot_;
+    }
+
+private:
+    std::size_t cursor_{0};
+    std::size_t slot_{0};
+};
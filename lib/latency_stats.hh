@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/// Monotonic timestamp in nanoseconds, comparable across threads
+inline std::int64_t nowNs() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Latency samples in nanoseconds with percentile queries.
+/// Recording is a push_back into reserved storage; sorting happens on the first query.
+class LatencySamples
+{
+public:
+    explicit LatencySamples(std::size_t expected = 0) { samples_.reserve(expected); }
+
+    void record(std::int64_t ns) {
+        samples_.push_back(ns);
+        sorted_ = false;
+    }
+
+    /// Appends every sample of `other`
+    void merge(const LatencySamples& other) {
+        samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+        sorted_ = samples_.empty();
+    }
+
+    std::size_t size() const noexcept { return samples_.size(); }
+
+    /// @param p percentile in [0, 100]
+    /// @return the sample at percentile `p`, or 0 when nothing was recorded
+    std::int64_t percentile(double p) {
+        if (samples_.empty()) {
+            return 0;
+        }
+        if (not sorted_) {
+            std::sort(samples_.begin(), samples_.end());
+            sorted_ = true;
+        }
+        auto rank = static_cast<std::size_t>(p / 100.0 * (samples_.size() - 1) + 0.5);
+        return samples_[std::min(rank, samples_.size() - 1)];
+    }
+
+    std::int64_t max() { return percentile(100); }
+
+    void clear() noexcept { samples_.clear(); }
+
+private:
+    std::vector<std::int64_t> samples_;
+    bool sorted_{true};
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// Hardware event counted for the calling thread and every thread it creates afterwards
+enum class PerfEvent { LlcReferences, LlcMisses };
+
+/// Thin wrapper over perf_event_open. Opening fails quietly (valid() is false) when the
+/// kernel, a container or perf_event_paranoid refuses access, or off Linux; callers report
+/// the counter as unavailable instead of aborting the run.
+class PerfCounter
+{
+public:
+    explicit PerfCounter(PerfEvent event) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = event == PerfEvent::LlcMisses ? PERF_COUNT_HW_CACHE_MISSES : PERF_COUNT_HW_CACHE_REFERENCES;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        (void)event;
+#endif
+    }
+
+    PerfCounter(PerfCounter const&) = delete;
+    PerfCounter& operator=(PerfCounter const&) = delete;
+
+    ~PerfCounter() {
+#ifdef __linux__
+        if (valid()) {
+            close(fd_);
+        }
+#endif
+    }
+
+    /// Returns whether the counter could be opened
+    bool valid() const noexcept { return fd_ >= 0; }
+
+    /// Enables the counter from the current total
+    void start() noexcept {
+#ifdef __linux__
+        if (valid()) {
+            // RESET clears the parent's own count only, not what exited threads added to it,
+            // so later stop() calls subtract the total read here instead
+            base_ = total();
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /// Disables the counter
+    /// @return the events counted since start(), including exited child threads; -1 if unavailable
+    std::int64_t stop() noexcept {
+#ifdef __linux__
+        if (valid()) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            auto count = total();
+            if (count >= 0 and base_ >= 0) {
+                return count - base_;
+            }
+        }
+#endif
+        return -1;
+    }
+
+private:
+#ifdef __linux__
+    /// Events counted since the counter was opened, including exited child threads
+    std::int64_t total() const noexcept {
+        std::uint64_t count = 0;
+        if (read(fd_, &count, sizeof(count)) == sizeof(count)) {
+            return static_cast<std::int64_t>(count);
+        }
+        return -1;
+    }
+#endif
+
+    int fd_{-1};
+    std::int64_t base_{0};
+};
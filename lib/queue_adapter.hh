@@ -0,0 +1,95 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+/// Queues with the rigtorp::SPSCQueue interface: try_push() and front()/pop()
+template<typename Q>
+concept FrontPopQueue = requires(Q& q, const typename Q::value_type& v) {
+    { q.try_push(v) } -> std::convertible_to<bool>;
+    { q.front() } -> std::convertible_to<typename Q::value_type*>;
+    q.pop();
+};
+
+/// Queues with the folly::ProducerConsumerQueue interface: write() and read()
+template<typename Q>
+concept WriteReadQueue = requires(Q& q, typename Q::value_type& v) {
+    { q.write(v) } -> std::convertible_to<bool>;
+    { q.read(v) } -> std::convertible_to<bool>;
+    { q.isEmpty() } -> std::convertible_to<bool>;
+};
+
+/// Queues with the boost::lockfree::spsc_queue interface: push()/pop() plus
+/// read_available()/write_available() instead of empty() and capacity()
+template<typename Q>
+concept AvailabilityQueue = requires(const Q& q) {
+    { q.read_available() } -> std::convertible_to<std::size_t>;
+    { q.write_available() } -> std::convertible_to<std::size_t>;
+};
+
+/// Non-blocking push for every queue in the repo.
+/// @return `true` if the operation is successful; `false` if the queue is full.
+template<typename Q>
+inline bool tryPush(Q& q, const typename Q::value_type& value) {
+    if constexpr (FrontPopQueue<Q>) {
+        return q.try_push(value);
+    } else if constexpr (WriteReadQueue<Q>) {
+        return q.write(value);
+    } else {
+        return q.push(value);
+    }
+}
+
+/// Non-blocking pop for every queue in the repo.
+/// @return `true` if the pop operation is successful; `false` if the queue is empty.
+template<typename Q>
+inline bool tryPop(Q& q, typename Q::value_type& value) {
+    if constexpr (FrontPopQueue<Q>) {
+        auto* front = q.front();
+        if (not front) {
+            return false;
+        }
+        value = *front;
+        q.pop();
+        return true;
+    } else if constexpr (WriteReadQueue<Q>) {
+        return q.read(value);
+    } else {
+        return q.pop(value);
+    }
+}
+
+/// Emptiness check for every queue in the repo
+template<typename Q>
+inline bool queueEmpty(const Q& q) {
+    if constexpr (WriteReadQueue<Q>) {
+        return q.isEmpty();
+    } else if constexpr (AvailabilityQueue<Q>) {
+        return q.read_available() == 0;
+    } else {
+        return q.empty();
+    }
+}
+
+/// Number of elements the queue holds when full. Where the queue does not report it
+/// (boost), this is only exact while neither side is running.
+template<typename Q>
+inline std::size_t queueCapacity(const Q& q) {
+    if constexpr (AvailabilityQueue<Q>) {
+        return q.read_available() + q.write_available();
+    } else {
+        return static_cast<std::size_t>(q.capacity());
+    }
+}
+
+/// Heap allocates a queue; queues sized at runtime get `capacity`, the others their template size
+template<typename Q>
+std::unique_ptr<Q> makeQueue(std::size_t capacity) {
+    if constexpr (std::is_constructible_v<Q, std::size_t> and not std::is_default_constructible_v<Q>) {
+        return std::make_unique<Q>(capacity);
+    } else {
+        return std::make_unique<Q>();
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+/// USDT probes on the slow paths of the SPSCLocal-protocol queues (SPSCLocal, SPSCCompact,
+/// SPSCInline), for bpftrace/perf on a live process. Compiled in only when QUEUE_PROBES is
+/// defined (CMake -DQUEUE_PROBES=ON) and <sys/sdt.h> is available, and then each site is a
+/// single NOP plus an ELF note until a tracer attaches. The fast paths carry no probes.
+///
+/// Provider `spsc`; the first argument is always the queue's address:
+/// - push_refresh(queue, pushCursor, popCursor): the producer reloaded the consumer's
+///   cursor because its cached copy said full; popCursor is the fresh value
+/// - push_full(queue, pushCursor, popCursor): ... and the queue really was full
+/// - pop_refresh(queue, popCursor, pushCursor): the consumer reloaded the producer's cursor
+/// - pop_empty(queue, popCursor, pushCursor): ... and the queue really was empty
+/// - push_batch(queue, pushCursor, count): a bulk push or commit() published `count` elements
+/// - pop_batch(queue, popCursor, count): a bulk pop or consume() released `count` elements
+#if defined(QUEUE_PROBES) && __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define QUEUE_PROBE(name, ...) STAP_PROBEV(spsc, name, __VA_ARGS__)
+#define QUEUE_PROBES_ENABLED 1
+#else
+#define QUEUE_PROBE(name, ...) ((void)0)
+#define QUEUE_PROBES_ENABLED 0
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+/// Two-sided 95% critical value of Student's t distribution with `dof` degrees of freedom.
+/// Tabulated up to 30, then stepped down to the next tabulated value, which errs on the
+/// wide side.
+inline double studentT95(double dof) noexcept {
+    static constexpr double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (not (dof >= 1)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (dof < 31) {
+        return table[static_cast<std::size_t>(dof) - 1];
+    }
+    if (dof < 40) {
+        return 2.042;
+    }
+    if (dof < 60) {
+        return 2.021;
+    }
+    if (dof < 120) {
+        return 2.000;
+    }
+    return 1.980;
+}
+
+/// Summary of repeated measurements of one quantity
+struct RunStats {
+    std::size_t count = 0;
+    double mean = 0;
+    double median = 0;
+    /// Sample standard deviation (n - 1)
+    double stddev = 0;
+    double min = 0;
+    double max = 0;
+    /// 95% confidence interval of the mean
+    double ciLow = 0;
+    double ciHigh = 0;
+};
+
+inline RunStats summarize(std::vector<double> samples) {
+    RunStats stats;
+    stats.count = samples.size();
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto n = double(samples.size());
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+    auto middle = samples.size() / 2;
+    stats.median = samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+    stats.min = samples.front();
+    stats.max = samples.back();
+    if (samples.size() > 1) {
+        double squares = 0;
+        for (auto sample : samples) {
+            squares += (sample - stats.mean) * (sample - stats.mean);
+        }
+        stats.stddev = std::sqrt(squares / (n - 1));
+    }
+    auto halfWidth = samples.size() > 1 ? studentT95(n - 1) * stats.stddev / std::sqrt(n) : 0.0;
+    stats.ciLow = stats.mean - halfWidth;
+    stats.ciHigh = stats.mean + halfWidth;
+    return stats;
+}
+
+/// Welch's unequal-variance t-test between two sets of samples
+struct WelchResult {
+    double t = 0;
+    double dof = 0;
+    /// Whether the means differ at the 95% level
+    bool significant = false;
+};
+
+inline WelchResult welchTest(const RunStats& a, const RunStats& b) noexcept {
+    WelchResult result;
+    if (a.count < 2 or b.count < 2) {
+        return result;
+    }
+    auto va = a.stddev * a.stddev / double(a.count);
+    auto vb = b.stddev * b.stddev / double(b.count);
+    if (va + vb == 0) {
+        // Identical, noise-free runs: any difference at all is significant
+        result.significant = a.mean != b.mean;
+        result.t = a.mean == b.mean ? 0 : std::copysign(std::numeric_limits<double>::infinity(), a.mean - b.mean);
+        result.dof = double(a.count + b.count - 2);
+        return result;
+    }
+    result.t = (a.mean - b.mean) / std::sqrt(va + vb);
+    result.dof = (va + vb) * (va + vb) / (va * va / double(a.count - 1) + vb * vb / double(b.count - 1));
+    result.significant = std::abs(result.t) > studentT95(result.dof);
+    return result;
+}
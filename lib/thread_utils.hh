@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+// Pinning of threads to a core is not supported in mac M1 chipset
+#ifdef APPLE_H
+
+    inline int pinThread(int cpu, pthread_t thread = pthread_self()) { return 0; }
+
+#else
+
+    /// Pins `thread` (the calling thread by default) to `cpu`; a negative cpu leaves the affinity untouched.
+    /// @return 0 on success, otherwise the error number (EINVAL for a cpu that does not exist or is not allowed).
+    inline int pinThread(int cpu, pthread_t thread = pthread_self()) {
+        if (cpu < 0) {
+            return 0;
+        }
+        if (cpu >= CPU_SETSIZE) {
+            return EINVAL;
+        }
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        return pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
+    }
+
+#endif
+
+/// Switches `thread` to SCHED_FIFO with `priority`; usually needs CAP_SYS_NICE.
+/// @return 0 on success, otherwise the error number.
+inline int setRealtimePriority(int priority, pthread_t thread = pthread_self()) {
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(thread, SCHED_FIFO, &param);
+}
+
+/// Locks current and future pages of the process in memory so the hot path never page faults.
+/// @return 0 on success, otherwise -1 with errno set.
+inline int lockMemory() {
+    return mlockall(MCL_CURRENT | MCL_FUTURE);
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "latency_stats.hh"
+#include "queue_adapter.hh"
+#include "thread_utils.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+/// Arrival process of the producer
+enum class Arrival
+{
+    /// Evenly spaced items
+    Constant,
+    /// Bursts of `burstItems` at `peakFactor` times the mean rate, then silence
+    OnOff,
+    /// Exponentially distributed gaps
+    Poisson,
+};
+
+/// What the producer does with an item when the queue is full
+enum class Overload
+{
+    /// Retry until there is room; the item is late but delivered
+    Backpressure,
+    /// Discard the item
+    Drop,
+};
+
+struct WorkloadConfig
+{
+    Arrival arrival{Arrival::Constant};
+    Overload overload{Overload::Backpressure};
+    /// Mean offered rate in items per second
+    double rate{1'000'000.0};
+    std::int64_t items{1 << 18};
+    /// OnOff only
+    std::int64_t burstItems{256};
+    double peakFactor{10.0};
+    /// Consumer busy-spins this long per item
+    std::int64_t workNs{0};
+    /// Consumer also writes this many bytes of a private buffer per item, one store per cache
+    /// line, walking through `workingSet` bytes so the ring is evicted over time
+    std::size_t touchBytes{0};
+    std::size_t workingSet{std::size_t{32} << 20};
+    int producerCpu{1};
+    int consumerCpu{2};
+    std::uint64_t seed{42};
+};
+
+/// Scheduled send times of every item, in ns from the start of the run; computed up front so
+/// the producer loop does no arithmetic beyond a clock read
+inline std::vector<std::int64_t> arrivalSchedule(const WorkloadConfig& config) {
+    std::vector<std::int64_t> schedule(static_cast<std::size_t>(config.items));
+    const double period = 1e9 / config.rate;
+    std::mt19937_64 rng{config.seed};
+    std::exponential_distribution<double> gap{1.0 / period};
+
+    double t = 0;
+    for (auto i = std::int64_t{}; i < config.items; ++i) {
+        schedule[i] = static_cast<std::int64_t>(t);
+        switch (config.arrival) {
+        case Arrival::Constant:
+            t += period;
+            break;
+        case Arrival::Poisson:
+            t += gap(rng);
+            break;
+        case Arrival::OnOff:
+            // Inside a burst items come peakFactor times faster; the pause after the burst
+            // restores the mean rate over the whole cycle
+            t += period / config.peakFactor;
+            if ((i + 1) % config.burstItems == 0) {
+                t += config.burstItems * period * (1.0 - 1.0 / config.peakFactor);
+            }
+            break;
+        }
+    }
+    return schedule;
+}
+
+/// Per-item consumer cost
+class ConsumerWork
+{
+public:
+    explicit ConsumerWork(const WorkloadConfig& config)
+        : workNs_{config.workNs}
+        , touchBytes_{config.touchBytes}
+        , buffer_(config.touchBytes ? config.workingSet : 0)
+    {}
+
+    void operator()() noexcept {
+        if (workNs_ > 0) {
+            auto until = nowNs() + workNs_;
+            while (nowNs() < until) {
+                ;
+            }
+        }
+        for (std::size_t n = 0; n < touchBytes_; n += lineSize) {
+            buffer_[offset_] += 1;
+            offset_ += lineSize;
+            if (offset_ >= buffer_.size()) {
+                offset_ = 0;
+            }
+        }
+    }
+
+private:
+    static constexpr std::size_t lineSize = 64;
+
+    std::int64_t workNs_;
+    std::size_t touchBytes_;
+    std::vector<unsigned char> buffer_;
+    std::size_t offset_{0};
+};
+
+struct WorkloadResult
+{
+    /// Scheduled send to dequeue-and-processed, in ns; measured from the schedule rather
+    /// than the actual send so a stalled producer does not hide queueing delay
+    LatencySamples latency;
+    std::int64_t delivered{0};
+    std::int64_t dropped{0};
+    /// Items that found the queue full at least once (Backpressure)
+    std::int64_t blocked{0};
+    std::int64_t elapsedNs{0};
+};
+
+/// Runs one producer following the arrival schedule and one consumer doing the configured
+/// work over `queue`, whose value type carries the scheduled send time.
+template<typename Q>
+WorkloadResult runWorkload(Q& queue, const WorkloadConfig& config, const std::vector<std::int64_t>& schedule) {
+    using value_type = typename Q::value_type;
+    WorkloadResult result;
+    result.latency = LatencySamples{static_cast<std::size_t>(config.items)};
+    std::atomic<bool> producerDone{false};
+    std::atomic<bool> consumerReady{false};
+    std::int64_t start = 0;
+
+    std::thread consumer{[&] {
+        pinThread(config.consumerCpu);
+        ConsumerWork work{config};
+        consumerReady.store(true, std::memory_order_release);
+        value_type value;
+        while (true) {
+            auto finished = producerDone.load(std::memory_order_acquire);
+            while (tryPop(queue, value)) {
+                work();
+                result.latency.record(nowNs() - (start + static_cast<std::int64_t>(value)));
+                ++result.delivered;
+            }
+            if (finished) {
+                break;
+            }
+        }
+    }};
+
+    pinThread(config.producerCpu);
+    while (not consumerReady.load(std::memory_order_acquire)) {
+        ;
+    }
+    // Published to the consumer by the first successful push
+    start = nowNs();
+    for (auto i = std::int64_t{}; i < config.items; ++i) {
+        const auto due = start + schedule[i];
+        while (nowNs() < due) {
+            ;
+        }
+        auto value = static_cast<value_type>(schedule[i]);
+        if (tryPush(queue, value)) {
+            continue;
+        }
+        if (config.overload == Overload::Drop) {
+            ++result.dropped;
+            continue;
+        }
+        ++result.blocked;
+        while (not tryPush(queue, value)) {
+            ;
+        }
+    }
+    producerDone.store(true, std::memory_order_release);
+    consumer.join();
+    result.elapsedNs = nowNs() - start;
+    return result;
+}
@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Benchmarks every queue with ../release/queue_bench and saves the results as JSON.
+# Given a baseline written the same way, also flags statistically significant
+# regressions (exit status 1 when there is one).
+#
+#   bash compare.sh results.json                 ## record
+#   bash compare.sh results.json baseline.json   ## record and compare
+
+if [[ -z "$1" ]]; then
+    echo "Usage: $0 <output.json> [baseline.json] [queue_bench options...]"
+    exit 1
+fi
+
+output=$1
+shift
+baseline=()
+if [[ -n "$1" && "$1" != --* ]]; then
+    baseline=(--baseline="$1")
+    shift
+fi
+
+../release/queue_bench --json="$output" "${baseline[@]}" --producer-cpu=1 --consumer-cpu=2 "$@"
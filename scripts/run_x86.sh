@@ -3,10 +3,7 @@
 # Print CPU information
 lscpu
 
-# Run performance stats on each executable in the ../release/ folder
-perf stat ../release/basic_spsc_queue
-perf stat ../release/basic_spsc_without_modulo_queue
-perf stat ../release/spsc_ra_pairs
-perf stat ../release/spsc_without_fs
-perf stat ../release/spsc_local_cache
-perf stat ../release/rigtorp_spsc
+# Run performance stats on one measured run of each queue with ../release/queue_bench
+for queue in $(../release/queue_bench --list); do
+    perf stat ../release/queue_bench --queue="$queue" --repetitions=1 --warmup=0
+done
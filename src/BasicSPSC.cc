@@ -1,6 +0,0 @@
-#include "custom_benchmark.hh"
-#include "BasicSPSC.hh"
-
-int main() {
-    bench<BasicSPSC<int_fast64_t>>();
-}
\ No newline at end of file
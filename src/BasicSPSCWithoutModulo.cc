@@ -1,6 +0,0 @@
-#include "custom_benchmark.hh"
-#include "BasicSPSCWithoutModulo.hh"
-
-int main() {
-    bench<BasicSPSCWithoutModulo<int_fast64_t>>();
-}
\ No newline at end of file
@@ -1,6 +0,0 @@
-#include "custom_benchmark.hh"
-#include "SPSCLocal.hh"
-
-int main() {
-    bench<SPSCLocal<int_fast64_t>>();
-}
\ No newline at end of file
@@ -1,6 +0,0 @@
-#include "custom_benchmark.hh"
-#include "SPSCWithRAPairs.hh"
-
-int main() {
-    bench<SPSCWithRAPairs<int_fast64_t>>();
-}
\ No newline at end of file
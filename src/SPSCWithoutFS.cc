@@ -1,6 +0,0 @@
-#include "custom_benchmark.hh"
-#include "SPSCWithoutFS.hh"
-
-int main() {
-    bench<SPSCWithoutFS<int_fast64_t>>();
-}
\ No newline at end of file
@@ -0,0 +1,320 @@
+// Benchmark driver for every SPSC queue: repeated Bench<T> runs with statistics, JSON
+// output and a regression check against a saved JSON baseline.
+//
+//   queue_bench --queue=spsc_local_cache --repetitions=20 --json=local.json
+//   queue_bench --baseline=local.json
+
+#include "BasicSPSC.hh"
+#include "BasicSPSCWithoutModulo.hh"
+#include "MutexQueue.hh"
+#include "ProducerConsumerQueue.hh"
+#include "SPSCLocal.hh"
+#include "SPSCWithRAPairs.hh"
+#include "SPSCWithoutFS.hh"
+#include "custom_benchmark.hh"
+#include "fifo4.hh"
+#include "rigtorp.hpp"
+#include "run_stats.hh"
+
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using Measure = double (*)(const BenchOptions&, std::int64_t);
+
+template<typename Q>
+static double measure(const BenchOptions& options, std::int64_t iterations) {
+    return Bench<Q>{options}(iterations);
+}
+
+/// Executable names of the former per-queue binaries, kept so old results stay comparable,
+/// followed by the third-party baselines. All are sized at runtime with --capacity;
+/// folly_pcq keeps one slot free, so it holds one element less.
+static const std::vector<std::string> queueNames = {
+    "basic_spsc_queue", "basic_spsc_without_modulo_queue", "spsc_ra_pairs", "spsc_without_fs",
+    "spsc_local_cache", "fifo4a", "rigtorp_spsc", "boost_spsc", "folly_pcq", "mutex_deque",
+};
+
+/// Capacities instantiated for the queues sized by a template parameter
+template<int... Ns>
+struct Capacities {};
+using FixedCapacities = Capacities<1 << 10, 1 << 12, 1 << 14, 1 << 17, 1 << 20>;
+
+template<typename T, int N>
+static Measure lookupFixed(const std::string& queue) {
+    if (queue == "basic_spsc_queue") {
+        return &measure<BasicSPSC<T, N>>;
+    }
+    if (queue == "basic_spsc_without_modulo_queue") {
+        return &measure<BasicSPSCWithoutModulo<T, N>>;
+    }
+    if (queue == "spsc_ra_pairs") {
+        return &measure<SPSCWithRAPairs<T, N>>;
+    }
+    if (queue == "spsc_without_fs") {
+        return &measure<SPSCWithoutFS<T, N>>;
+    }
+    if (queue == "spsc_local_cache") {
+        return &measure<SPSCLocal<T, N>>;
+    }
+    return nullptr;
+}
+
+template<typename T, int... Ns>
+static Measure lookup(const std::string& queue, std::size_t capacity, Capacities<Ns...>) {
+    if (queue == "fifo4a") {
+        return &measure<Fifo4a<T>>;
+    }
+    if (queue == "rigtorp_spsc") {
+        return &measure<rigtorp::SPSCQueue<T>>;
+    }
+    if (queue == "boost_spsc") {
+        return &measure<boost::lockfree::spsc_queue<T>>;
+    }
+    if (queue == "folly_pcq") {
+        return &measure<folly::ProducerConsumerQueue<T>>;
+    }
+    if (queue == "mutex_deque") {
+        return &measure<MutexQueue<T>>;
+    }
+    Measure found = nullptr;
+    ((capacity == std::size_t{Ns} ? (found = lookupFixed<T, Ns>(queue), 0) : 0), ...);
+    if (not found) {
+        throw std::invalid_argument("capacity " + std::to_string(capacity) + " is not instantiated for " + queue +
+                                    " (1024, 4096, 16384, 131072, 1048576)");
+    }
+    return found;
+}
+
+struct DriverOptions {
+    std::string queue = "all";
+    std::string element = "int64";
+    std::size_t capacity = 1 << 17;
+    std::int64_t iterations = 400'000'000;
+    int repetitions = 10;
+    int warmup = 1;
+    int producerCpu = -1;
+    int consumerCpu = -1;
+    std::string json;
+    std::string baseline;
+    /// Smallest relative change of the mean, in percent, reported as a regression
+    double threshold = 1.0;
+};
+
+struct Result {
+    std::string name;
+    std::string queue;
+    std::vector<double> samples;
+    RunStats stats;
+};
+
+static void usage(std::ostream& out) {
+    out << "usage: queue_bench [--queue=NAME|all] [--element=int32|int64] [--capacity=N]\n"
+           "                   [--iterations=N] [--repetitions=N] [--warmup=N]\n"
+           "                   [--producer-cpu=N] [--consumer-cpu=N] [--json=FILE]\n"
+           "                   [--baseline=FILE] [--threshold=PERCENT] [--list]\n";
+}
+
+static DriverOptions parse(int argc, char** argv) {
+    DriverOptions options;
+    for (auto i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--list") {
+            for (const auto& name : queueNames) {
+                std::cout << name << '\n';
+            }
+            std::exit(EXIT_SUCCESS);
+        }
+        if (arg == "--help") {
+            usage(std::cout);
+            std::exit(EXIT_SUCCESS);
+        }
+        auto equals = arg.find('=');
+        if (arg.rfind("--", 0) != 0 or equals == std::string::npos) {
+            throw std::invalid_argument("unexpected argument " + arg);
+        }
+        auto key = arg.substr(2, equals - 2);
+        auto value = arg.substr(equals + 1);
+        if (key == "queue") {
+            options.queue = value;
+        } else if (key == "element") {
+            options.element = value;
+        } else if (key == "capacity") {
+            options.capacity = std::stoull(value);
+        } else if (key == "iterations") {
+            options.iterations = std::stoll(value);
+        } else if (key == "repetitions") {
+            options.repetitions = std::stoi(value);
+        } else if (key == "warmup") {
+            options.warmup = std::stoi(value);
+        } else if (key == "producer-cpu") {
+            options.producerCpu = std::stoi(value);
+        } else if (key == "consumer-cpu") {
+            options.consumerCpu = std::stoi(value);
+        } else if (key == "json") {
+            options.json = value;
+        } else if (key == "baseline") {
+            options.baseline = value;
+        } else if (key == "threshold") {
+            options.threshold = std::stod(value);
+        } else {
+            throw std::invalid_argument("unknown option --" + key);
+        }
+    }
+    if (options.element != "int32" and options.element != "int64") {
+        throw std::invalid_argument("element must be int32 or int64");
+    }
+    if (options.repetitions < 1 or options.iterations < 1 or options.capacity < 2 or
+        (options.capacity & (options.capacity - 1)) != 0) {
+        throw std::invalid_argument("repetitions and iterations must be positive, capacity a power of two");
+    }
+    // Sequence numbers travel as the element type
+    auto limit = options.element == "int32" ? std::int64_t{std::numeric_limits<std::int32_t>::max()}
+                                            : std::numeric_limits<std::int64_t>::max();
+    if (options.iterations > limit - static_cast<std::int64_t>(options.capacity)) {
+        throw std::invalid_argument("iterations overflow the element type");
+    }
+    return options;
+}
+
+static Result run(const std::string& queue, const DriverOptions& options) {
+    auto measure = options.element == "int32" ? lookup<std::int32_t>(queue, options.capacity, FixedCapacities{})
+                                              : lookup<std::int64_t>(queue, options.capacity, FixedCapacities{});
+    BenchOptions bench{options.capacity, options.producerCpu, options.consumerCpu};
+
+    Result result;
+    result.queue = queue;
+    result.name = queue + "/" + options.element + "/" + std::to_string(options.capacity);
+    for (auto i = 0; i < options.warmup; ++i) {
+        measure(bench, options.iterations);
+    }
+    for (auto i = 0; i < options.repetitions; ++i) {
+        result.samples.push_back(measure(bench, options.iterations));
+    }
+    result.stats = summarize(result.samples);
+    return result;
+}
+
+/// One result per line, so readBaseline() can stay a line scanner
+static void writeJson(std::ostream& out, const DriverOptions& options, const std::vector<Result>& results) {
+    out << std::setprecision(17);
+    out << "{\n  \"iterations\": " << options.iterations << ", \"repetitions\": " << options.repetitions
+        << ", \"warmup\": " << options.warmup << ", \"producer_cpu\": " << options.producerCpu
+        << ", \"consumer_cpu\": " << options.consumerCpu << ",\n  \"results\": [\n";
+    for (auto r = std::size_t{}; r < results.size(); ++r) {
+        const auto& result = results[r];
+        const auto& s = result.stats;
+        out << "    {\"name\": \"" << result.name << "\", \"queue\": \"" << result.queue << "\", \"element\": \""
+            << options.element << "\", \"capacity\": " << options.capacity << ", \"unit\": \"ops/sec\""
+            << ", \"mean\": " << s.mean << ", \"median\": " << s.median << ", \"stddev\": " << s.stddev
+            << ", \"min\": " << s.min << ", \"max\": " << s.max << ", \"ci95_low\": " << s.ciLow
+            << ", \"ci95_high\": " << s.ciHigh << ", \"samples\": [";
+        for (auto i = std::size_t{}; i < result.samples.size(); ++i) {
+            out << (i ? ", " : "") << result.samples[i];
+        }
+        out << "]}" << (r + 1 < results.size() ? "," : "") << '\n';
+    }
+    out << "  ]\n}\n";
+}
+
+/// Samples by result name from a file written by writeJson()
+static std::map<std::string, std::vector<double>> readBaseline(const std::string& path) {
+    std::ifstream in{path};
+    if (not in) {
+        throw std::invalid_argument("cannot read baseline " + path);
+    }
+    std::map<std::string, std::vector<double>> baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        auto name = line.find("\"name\": \"");
+        auto samples = line.find("\"samples\": [");
+        if (name == std::string::npos or samples == std::string::npos) {
+            continue;
+        }
+        name += 9;
+        auto& values = baseline[line.substr(name, line.find('"', name) - name)];
+        samples += 12;
+        std::istringstream list{line.substr(samples, line.find(']', samples) - samples)};
+        std::string value;
+        while (std::getline(list, value, ',')) {
+            values.push_back(std::stod(value));
+        }
+    }
+    return baseline;
+}
+
+/// @return the number of significant regressions
+static int compare(const std::vector<Result>& results, const std::string& path, double threshold) {
+    auto baseline = readBaseline(path);
+    int regressions = 0;
+    std::cout << "\nComparison against " << path << " (Welch t-test, 95%, threshold " << threshold << "%)\n";
+    for (const auto& result : results) {
+        std::cout << std::setw(48) << std::left << result.name;
+        auto found = baseline.find(result.name);
+        if (found == baseline.end()) {
+            std::cout << "not in baseline\n";
+            continue;
+        }
+        auto before = summarize(found->second);
+        auto test = welchTest(result.stats, before);
+        auto change = 100.0 * (result.stats.mean - before.mean) / before.mean;
+        const char* verdict = "unchanged";
+        if (test.significant and std::abs(change) >= threshold) {
+            verdict = change < 0 ? "REGRESSION" : "improvement";
+            regressions += change < 0;
+        }
+        std::cout << std::showpos << std::fixed << std::setprecision(2) << std::setw(8) << std::right << change
+                  << "%" << std::noshowpos << "  t=" << std::setw(7) << test.t << "  " << verdict << '\n';
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    DriverOptions options;
+    try {
+        options = parse(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "queue_bench: " << e.what() << '\n';
+        usage(std::cerr);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Result> results;
+    try {
+        for (const auto& queue : queueNames) {
+            if (options.queue != "all" and options.queue != queue) {
+                continue;
+            }
+            results.push_back(run(queue, options));
+            const auto& s = results.back().stats;
+            std::cout << std::fixed << std::setprecision(0) << std::setw(48) << std::left << results.back().name
+                      << std::right << " median " << std::setw(14) << s.median << "  mean " << std::setw(14)
+                      << s.mean << " [" << s.ciLow << ", " << s.ciHigh << "]  stddev " << s.stddev << "  min "
+                      << s.min << "  max " << s.max << " ops/s\n";
+        }
+        if (results.empty()) {
+            throw std::invalid_argument("unknown queue " + options.queue + " (see --list)");
+        }
+        if (not options.json.empty()) {
+            std::ofstream out{options.json};
+            writeJson(out, options, results);
+        }
+        if (not options.baseline.empty() and compare(results, options.baseline, options.threshold) > 0) {
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "queue_bench: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,10 +1,57 @@
 #include "BasicSPSC.hh"
 #include "BasicSPSCWithoutModulo.hh"
 #include "SPSCLocal.hh"
+#include "SPSCCompact.hh"
+#include "SPSCInline.hh"
+#include "AsyncSPSC.hh"
+#include "BoundedMPMC.hh"
+#include "ConflatingQueue.hh"
+#include "FanIn.hh"
+#include "IntrusiveMPSC.hh"
+#include "Journal.hh"
+#include "MutexQueue.hh"
+#include "PartitionedDispatcher.hh"
+#include "ProducerConsumerQueue.hh"
+#include "Reorderer.hh"
+#include "rigtorp.hpp"
+#include "Seqlock.hh"
+#include "SeqlockRing.hh"
+#include "WorkStealingDeque.hh"
+#include "WorkStealingPool.hh"
+#include "bulk_copy.hh"
+#include "cache_line.hh"
+#include "index_policy.hh"
+#include "latency_stats.hh"
+#include "queue_adapter.hh"
+#include "run_stats.hh"
+#include "workload.hh"
+#include "executor.hh"
+#include "Pipeline.hh"
+#ifdef __linux__
+#include "AsyncLogger.hh"
+#include "BatchSink.hh"
+#include "MirroredAllocator.hh"
+#include "NotifyingSPSC.hh"
+#include "ReservedAllocator.hh"
+#include <poll.h>
+#include <sys/socket.h>
+#endif
 
 #include <gtest/gtest.h>
+#include <boost/lockfree/spsc_queue.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 
 extern "C" {
@@ -34,7 +81,12 @@ using test_type = unsigned int;
 template<typename FifoT> using FifoTest = FifoTestBase<FifoT>;
 using FifoTypes = ::testing::Types<
     BasicSPSC<test_type, 4>,
-    BasicSPSCWithoutModulo<test_type, 4>
+    BasicSPSCWithoutModulo<test_type, 4>,
+    BoundedMPMC<test_type, 4>,
+    SPSCLocal<test_type, 4>,
+    SPSCLocal<test_type, 4, std::allocator<test_type>, FastModIndex<4>>,
+    SPSCLocal<test_type, 4, std::allocator<test_type>, WrapIndex<4>>,
+    SPSCInline<test_type, 4>
     >;
 TYPED_TEST_SUITE(FifoTest, FifoTypes);
 
@@ -151,4 +203,1517 @@ TYPED_TEST(FifoTest, wrap) {
         EXPECT_TRUE(this->fifo.pop(value));
         EXPECT_EQ(42 + i, value);
     }
-}
\ No newline at end of file
+}
+
+namespace {
+
+DetachedTask awaitPops(AsyncSPSC<test_type, 4>& fifo, std::vector<test_type>& out, int count) {
+    for (auto i = 0; i < count; ++i) {
+        out.push_back(co_await fifo.async_pop());
+    }
+}
+
+DetachedTask awaitPushes(AsyncSPSC<test_type, 4>& fifo, int& pushed, int count) {
+    for (auto i = 0; i < count; ++i) {
+        co_await fifo.async_push(42 + i);
+        ++pushed;
+    }
+}
+
+DetachedTask awaitPopOn(SingleThreadExecutor& executor, AsyncSPSC<test_type, 4>& fifo, std::vector<test_type>& out) {
+    co_await executor.schedule();
+    out.push_back(co_await fifo.async_pop(&executor));
+}
+
+}  // namespace
+
+TEST(AsyncSPSCTest, fastPathDoesNotSuspend) {
+    AsyncSPSC<test_type, 4> fifo;
+    for (auto i = 0u; i < fifo.capacity(); ++i) {
+        EXPECT_TRUE(fifo.push(42 + i));
+    }
+
+    std::vector<test_type> out;
+    awaitPops(fifo, out, 4);
+    ASSERT_EQ(4u, out.size());
+    for (auto i = 0u; i < out.size(); ++i) {
+        EXPECT_EQ(42 + i, out[i]);
+    }
+    EXPECT_TRUE(fifo.empty());
+}
+
+TEST(AsyncSPSCTest, pushResumesSuspendedConsumer) {
+    AsyncSPSC<test_type, 4> fifo;
+    std::vector<test_type> out;
+    awaitPops(fifo, out, 2);
+    EXPECT_TRUE(out.empty());
+
+    EXPECT_TRUE(fifo.push(42));
+    ASSERT_EQ(1u, out.size());
+    EXPECT_EQ(42u, out[0]);
+
+    EXPECT_TRUE(fifo.push(43));
+    ASSERT_EQ(2u, out.size());
+    EXPECT_EQ(43u, out[1]);
+    EXPECT_TRUE(fifo.empty());
+}
+
+TEST(AsyncSPSCTest, popResumesSuspendedProducer) {
+    AsyncSPSC<test_type, 4> fifo;
+    int pushed = 0;
+    awaitPushes(fifo, pushed, 6);
+    EXPECT_EQ(4, pushed);
+    EXPECT_TRUE(fifo.full());
+
+    auto value = test_type{};
+    EXPECT_TRUE(fifo.pop(value));
+    EXPECT_EQ(42u, value);
+    EXPECT_EQ(5, pushed);
+    EXPECT_TRUE(fifo.full());
+
+    EXPECT_TRUE(fifo.pop(value));
+    EXPECT_EQ(43u, value);
+    EXPECT_EQ(6, pushed);
+}
+
+TEST(AsyncSPSCTest, wakeupIsScheduledOnExecutor) {
+    AsyncSPSC<test_type, 4> fifo;
+    SingleThreadExecutor executor;
+    std::vector<test_type> out;
+    awaitPopOn(executor, fifo, out);
+    EXPECT_EQ(1u, executor.poll());
+    EXPECT_TRUE(out.empty());
+
+    EXPECT_TRUE(fifo.push(42));
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(1u, executor.poll());
+    ASSERT_EQ(1u, out.size());
+    EXPECT_EQ(42u, out[0]);
+}
+
+TEST(AsyncSPSCTest, crossThreadTransfer) {
+    constexpr test_type count = 10'000;
+    AsyncSPSC<test_type, 4> fifo;
+    SingleThreadExecutor consumer;
+    test_type received = 0;
+    bool ordered = true;
+
+    auto consume = [&]() -> DetachedTask {
+        co_await consumer.schedule();
+        for (auto i = test_type{}; i < count; ++i) {
+            ordered &= (co_await fifo.async_pop(&consumer)) == i;
+            ++received;
+        }
+        consumer.stop();
+    };
+
+    std::thread th([&] {
+        consume();
+        consumer.run();
+    });
+    for (auto i = test_type{}; i < count; ++i) {
+        while (not fifo.push(i)) {
+            ;
+        }
+    }
+    th.join();
+    EXPECT_EQ(count, received);
+    EXPECT_TRUE(ordered);
+}
+
+TEST(PipelineTest, stagesRunInOrderAndDrainOnStop) {
+    constexpr int count = 1000;
+    auto pipeline = makePipeline<int>(PipelineConfig{},
+        [](int value) { return value + 1; },
+        [](int value) { return static_cast<long>(value) * 2; },
+        [](long value) { return std::to_string(value); });
+    static_assert(decltype(pipeline)::hasOutput);
+    pipeline.start();
+
+    std::vector<std::string> out;
+    for (auto i = 0; i < count; ++i) {
+        while (not pipeline.push(i)) {
+            ;
+        }
+    }
+    pipeline.close();
+    std::string value;
+    while (true) {
+        if (pipeline.pop(value)) {
+            out.push_back(value);
+        } else if (pipeline.finished()) {
+            while (pipeline.pop(value)) {
+                out.push_back(value);
+            }
+            break;
+        }
+    }
+    pipeline.stop();
+
+    ASSERT_EQ(static_cast<std::size_t>(count), out.size());
+    for (auto i = 0; i < count; ++i) {
+        EXPECT_EQ(std::to_string((i + 1) * 2), out[i]);
+    }
+}
+
+TEST(PipelineTest, sinkStageHasNoOutputQueue) {
+    long sum = 0;
+    {
+        auto pipeline = makePipeline<int>(PipelineConfig{},
+            [](int value) { return value * 3; },
+            [&sum](int value) { sum += value; });
+        static_assert(not decltype(pipeline)::hasOutput);
+        pipeline.start();
+        for (auto i = 0; i < 100; ++i) {
+            while (not pipeline.push(i)) {
+                ;
+            }
+        }
+        pipeline.stop();
+    }
+    EXPECT_EQ(3 * 99 * 100 / 2, sum);
+}
+
+TEST(FanInTest, roundRobinInterleavesQueues) {
+    FanIn<SPSCLocal<test_type, 8>> fanIn{3};
+    for (auto i = 0u; i < 3; ++i) {
+        EXPECT_TRUE(fanIn.push(0, 10 + i));
+        EXPECT_TRUE(fanIn.push(2, 30 + i));
+    }
+
+    std::vector<test_type> out;
+    auto collect = [&](std::size_t, test_type value) { out.push_back(value); };
+    EXPECT_EQ(2u, fanIn.poll(collect));
+    EXPECT_EQ(2u, fanIn.poll(collect));
+    EXPECT_EQ(2u, fanIn.poll(collect));
+    EXPECT_EQ(0u, fanIn.poll(collect));
+    EXPECT_EQ((std::vector<test_type>{10, 30, 11, 31, 12, 32}), out);
+}
+
+TEST(FanInTest, weightedPriorityServesLowIndexFirst) {
+    FanIn<SPSCLocal<test_type, 8>> fanIn{2, FanInMode::WeightedPriority};
+    fanIn.setWeight(0, 3);
+    for (auto i = 0u; i < 4; ++i) {
+        EXPECT_TRUE(fanIn.push(1, 20 + i));
+        EXPECT_TRUE(fanIn.push(0, 10 + i));
+    }
+
+    std::vector<std::size_t> from;
+    auto collect = [&](std::size_t index, test_type) { from.push_back(index); };
+    EXPECT_EQ(4u, fanIn.poll(collect));
+    EXPECT_EQ((std::vector<std::size_t>{0, 0, 0, 1}), from);
+}
+
+TEST(FanInTest, drainBatchEmptiesQueueUpToBatch) {
+    FanIn<SPSCLocal<test_type, 8>> fanIn{70, FanInMode::DrainBatch};
+    fanIn.setBatch(4);
+    for (auto i = 0u; i < 6; ++i) {
+        EXPECT_TRUE(fanIn.push(65, i));
+    }
+    EXPECT_TRUE(fanIn.push(3, 42));
+
+    std::vector<std::size_t> from;
+    auto collect = [&](std::size_t index, test_type) { from.push_back(index); };
+    EXPECT_EQ(5u, fanIn.poll(collect));
+    EXPECT_EQ(2u, fanIn.poll(collect));
+    EXPECT_EQ((std::vector<std::size_t>{3, 65, 65, 65, 65, 65, 65}), from);
+}
+
+TEST(FanInTest, producersOnManyThreads) {
+    constexpr auto producers = 4u;
+    constexpr auto items = 10000u;
+    FanIn<SPSCLocal<test_type, 64>> fanIn{producers};
+
+    std::vector<std::thread> threads;
+    for (auto p = 0u; p < producers; ++p) {
+        threads.emplace_back([&fanIn, p] {
+            for (auto i = 0u; i < items; ++i) {
+                while (not fanIn.push(p, i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<test_type> next(producers, 0);
+    auto received = 0u;
+    while (received < producers * items) {
+        received += fanIn.poll([&](std::size_t index, test_type value) {
+            EXPECT_EQ(next[index]++, value);
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+}
+
+TEST(FanInTest, lostFlagIsSweptWhileOtherQueuesStayBusy) {
+    using Fan = FanIn<SPSCLocal<test_type, 8>>;
+    Fan fanIn{3};
+    // Pushed behind the bitmap's back, like a push whose flag the consumer cleared
+    EXPECT_TRUE(fanIn.queue(0).push(7));
+
+    bool delivered = false;
+    for (auto poll = 0u; poll <= Fan::sweepInterval and not delivered; ++poll) {
+        EXPECT_TRUE(fanIn.push(1, poll));
+        EXPECT_TRUE(fanIn.push(2, poll));
+        fanIn.poll([&](std::size_t index, test_type value) {
+            if (index == 0) {
+                EXPECT_EQ(7, value);
+                delivered = true;
+            }
+        });
+    }
+    EXPECT_TRUE(delivered);
+}
+
+TEST(FanInTest, rejectsQueueCountBeforeAllocating) {
+    using Fan = FanIn<SPSCLocal<test_type, 8>>;
+    EXPECT_THROW(Fan{0}, std::invalid_argument);
+    EXPECT_THROW(Fan{Fan::maxQueues + 1}, std::invalid_argument);
+    EXPECT_THROW(Fan{~std::size_t{0}}, std::invalid_argument);
+}
+
+TEST(PartitionedDispatcherTest, spillKeepsPerPartitionOrder) {
+    using Fifo = SPSCLocal<std::int64_t, 8>;
+    auto instrument = [](std::int64_t value) { return value % 5; };
+    PartitionedDispatcher<Fifo, decltype(instrument)> dispatcher{2, instrument, PartitionFull::Spill, 3};
+
+    for (auto i = std::int64_t{}; i < 100; ++i) {
+        EXPECT_TRUE(dispatcher.dispatch(i));
+    }
+    EXPECT_GT(dispatcher.spilled(), 0u);
+
+    std::vector<std::int64_t> received[2];
+    std::int64_t value;
+    do {
+        for (auto p = 0; p < 2; ++p) {
+            while (dispatcher.queue(p).pop(value)) {
+                received[p].push_back(value);
+            }
+        }
+    } while (dispatcher.flush() > 0 or not dispatcher.queue(0).empty() or not dispatcher.queue(1).empty());
+
+    for (auto p = 0; p < 2; ++p) {
+        EXPECT_TRUE(std::is_sorted(received[p].begin(), received[p].end()));
+        EXPECT_TRUE(std::all_of(received[p].begin(), received[p].end(), [&](auto v) { return v % 5 % 2 == p; }));
+    }
+    EXPECT_EQ(100u, received[0].size() + received[1].size());
+}
+
+TEST(PartitionedDispatcherTest, reportRefusesOnceStageAndRingAreFull) {
+    using Fifo = SPSCLocal<std::int64_t, 4>;
+    PartitionedDispatcher<Fifo, std::hash<std::int64_t>> dispatcher{1, {}, PartitionFull::Report, 2};
+    auto accepted = 0;
+    for (auto i = std::int64_t{}; i < 10; ++i) {
+        accepted += dispatcher.dispatch(i);
+    }
+    // Four in the ring, two staged
+    EXPECT_EQ(6, accepted);
+    EXPECT_EQ(2u, dispatcher.flush());
+
+    std::int64_t value;
+    EXPECT_TRUE(dispatcher.queue(0).pop(value));
+    EXPECT_EQ(0, value);
+    EXPECT_EQ(1u, dispatcher.flush());
+    EXPECT_TRUE(dispatcher.dispatch(42));
+}
+
+TEST(PartitionedDispatcherTest, blockingProducerFeedsConsumerThreads) {
+    using Fifo = SPSCLocal<std::int64_t, 16>;
+    constexpr std::int64_t items = 20'000;
+    constexpr std::size_t partitions = 3;
+    PartitionedDispatcher<Fifo, std::hash<std::int64_t>> dispatcher{partitions};
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> consumers;
+    std::vector<std::int64_t> counts(partitions);
+    for (auto p = std::size_t{}; p < partitions; ++p) {
+        consumers.emplace_back([&, p] {
+            std::int64_t last = -1;
+            std::int64_t value;
+            while (true) {
+                if (dispatcher.queue(p).pop(value)) {
+                    EXPECT_LT(last, value);
+                    EXPECT_EQ(p, dispatcher.partitionOf(value));
+                    last = value;
+                    ++counts[p];
+                } else if (done.load(std::memory_order_acquire)) {
+                    if (dispatcher.queue(p).empty()) {
+                        break;
+                    }
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto i = std::int64_t{}; i < items; ++i) {
+        dispatcher.dispatch(i);
+    }
+    EXPECT_EQ(0u, dispatcher.flush());
+    done.store(true, std::memory_order_release);
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+    EXPECT_EQ(items, std::accumulate(counts.begin(), counts.end(), std::int64_t{}));
+}
+
+TEST(ReordererTest, parksResultsBeyondTheWindowUntilTheGapCloses) {
+    Reorderer<int, 4, SPSCLocal<Sequenced<int>, 16>> reorderer{2};
+    std::vector<std::uint64_t> order;
+    auto collect = [&](std::uint64_t sequence, int value) {
+        EXPECT_EQ(int(sequence) * 10, value);
+        order.push_back(sequence);
+    };
+
+    // Worker 1 runs ahead with the odd sequence numbers
+    for (auto sequence = 1; sequence < 20; sequence += 2) {
+        EXPECT_TRUE(reorderer.push(1, sequence, sequence * 10));
+    }
+    EXPECT_EQ(0u, reorderer.poll(collect));
+    EXPECT_EQ(2u, reorderer.waiting());
+
+    for (auto sequence = 0; sequence < 20; sequence += 2) {
+        EXPECT_TRUE(reorderer.push(0, sequence, sequence * 10));
+    }
+    while (reorderer.next() < 20) {
+        reorderer.poll(collect);
+    }
+    EXPECT_EQ(20u, order.size());
+    EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+    EXPECT_EQ(0u, reorderer.waiting());
+}
+
+TEST(ReordererTest, restoresOrderBehindConcurrentWorkers) {
+    constexpr std::uint64_t items = 30'000;
+    constexpr std::size_t workers = 3;
+    Reorderer<std::uint64_t, 64> reorderer{workers};
+
+    std::vector<std::thread> threads;
+    for (auto w = std::size_t{}; w < workers; ++w) {
+        threads.emplace_back([&, w] {
+            std::uint64_t spin = w;
+            for (auto sequence = std::uint64_t{w}; sequence < items; sequence += workers) {
+                // Uneven service times
+                for (auto i = spin % 7 * 20; i > 0; --i) {
+                    spin = spin * 6364136223846793005u + 1442695040888963407u;
+                }
+                ++spin;
+                while (not reorderer.push(w, sequence, sequence + 1)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::uint64_t expected = 0;
+    while (expected < items) {
+        if (reorderer.poll([&](std::uint64_t sequence, std::uint64_t value) {
+                EXPECT_EQ(expected, sequence);
+                EXPECT_EQ(sequence + 1, value);
+                ++expected;
+            }) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+struct MailboxEvent : MPSCHook {
+    std::uint64_t producer;
+    std::uint64_t sequence;
+};
+
+TEST(IntrusiveMPSCTest, linksObjectsInOrderAndReusesThem) {
+    IntrusiveMPSC<MailboxEvent> mailbox;
+    MailboxEvent events[3]{};
+    EXPECT_TRUE(mailbox.empty());
+    EXPECT_EQ(nullptr, mailbox.pop());
+
+    for (auto round = 0; round < 3; ++round) {
+        for (auto i = 0u; i < 3; ++i) {
+            events[i].sequence = i;
+            mailbox.push(&events[i]);
+        }
+        EXPECT_FALSE(mailbox.empty());
+        for (auto i = 0u; i < 3; ++i) {
+            EXPECT_EQ(&events[i], mailbox.pop());
+        }
+        EXPECT_EQ(nullptr, mailbox.pop());
+        EXPECT_TRUE(mailbox.empty());
+    }
+}
+
+TEST(IntrusiveMPSCTest, keepsPerProducerOrderUnderContention) {
+    constexpr std::uint64_t producers = 4;
+    constexpr std::uint64_t perProducer = 5000;
+    IntrusiveMPSC<MailboxEvent> mailbox;
+    std::vector<MailboxEvent> pool(producers * perProducer);
+
+    std::vector<std::thread> threads;
+    for (auto p = std::uint64_t{}; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (auto i = std::uint64_t{}; i < perProducer; ++i) {
+                auto& event = pool[p * perProducer + i];
+                event.producer = p;
+                event.sequence = i;
+                mailbox.push(&event);
+            }
+        });
+    }
+    std::vector<std::uint64_t> next(producers);
+    for (auto received = std::uint64_t{}; received < producers * perProducer;) {
+        if (auto* event = mailbox.pop()) {
+            EXPECT_EQ(next[event->producer]++, event->sequence);
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(nullptr, mailbox.pop());
+}
+
+TEST(WorkStealingDequeTest, ownerIsLifoThiefIsFifoAndRingGrows) {
+    WorkStealingDeque<test_type, 4> deque;
+    for (auto i = 0u; i < 10; ++i) {
+        deque.push(42 + i);
+    }
+    EXPECT_EQ(10u, deque.size());
+    EXPECT_EQ(16u, deque.capacity());
+
+    auto value = test_type{};
+    EXPECT_TRUE(deque.steal(value));
+    EXPECT_EQ(42u, value);
+    EXPECT_TRUE(deque.pop(value));
+    EXPECT_EQ(51u, value);
+    for (auto i = 0u; i < 8; ++i) {
+        EXPECT_TRUE(deque.pop(value));
+    }
+    EXPECT_EQ(43u, value);
+    EXPECT_FALSE(deque.pop(value));
+    EXPECT_FALSE(deque.steal(value));
+    EXPECT_TRUE(deque.empty());
+}
+
+TEST(WorkStealingDequeTest, everyElementTakenOnceUnderStealing) {
+    constexpr auto items = 20000u;
+    WorkStealingDeque<test_type, 8> deque;
+    std::vector<std::atomic<int>> taken(items);
+    std::atomic<bool> done{false};
+
+    auto thief = [&] {
+        auto value = test_type{};
+        while (not done.load(std::memory_order_acquire)) {
+            if (deque.steal(value)) {
+                ++taken[value];
+            }
+        }
+    };
+    std::thread first{thief};
+    std::thread second{thief};
+
+    auto value = test_type{};
+    for (auto i = 0u; i < items; ++i) {
+        deque.push(i);
+        if (i % 3 == 0 and deque.pop(value)) {
+            ++taken[value];
+        }
+    }
+    while (deque.pop(value)) {
+        ++taken[value];
+    }
+    done.store(true, std::memory_order_release);
+    first.join();
+    second.join();
+
+    for (auto i = 0u; i < items; ++i) {
+        EXPECT_EQ(1, taken[i].load()) << i;
+    }
+}
+
+namespace {
+
+/// Spawns two children until depth reaches zero
+struct ForkTask : Task {
+    WorkStealingPool* pool;
+    std::atomic<int>* leaves;
+    std::vector<ForkTask>* tree;
+    std::size_t node;
+    int depth;
+
+    ForkTask(WorkStealingPool* p, std::atomic<int>* l, std::vector<ForkTask>* t, std::size_t n, int d)
+        : pool{p}, leaves{l}, tree{t}, node{n}, depth{d} {}
+
+    void execute() override {
+        if (depth == 0) {
+            leaves->fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        EXPECT_GE(pool->workerIndex(), 0);
+        pool->submit(&(*tree)[2 * node + 1]);
+        pool->submit(&(*tree)[2 * node + 2]);
+    }
+};
+
+}  // namespace
+
+TEST(WorkStealingPoolTest, runsTasksSpawnedByTasks) {
+    constexpr auto depth = 10;
+    std::atomic<int> leaves{0};
+    WorkStealingPool pool{3};
+    EXPECT_EQ(-1, pool.workerIndex());
+
+    std::vector<ForkTask> tree;
+    for (auto node = std::size_t{}; node < (std::size_t{2} << depth) - 1; ++node) {
+        auto level = 0;
+        while ((std::size_t{2} << level) - 1 <= node) {
+            ++level;
+        }
+        tree.emplace_back(&pool, &leaves, &tree, node, depth - level);
+    }
+    pool.submit(&tree[0]);
+    while (leaves.load(std::memory_order_relaxed) < (1 << depth)) {
+        std::this_thread::yield();
+    }
+    pool.stop();
+    EXPECT_EQ(1 << depth, leaves.load());
+}
+
+TEST(SeqlockRingTest, readersFollowIndependently) {
+    SeqlockRing<test_type, 4> ring;
+    auto first = ring.reader();
+    ring.push(42);
+    auto second = ring.reader();
+    ring.push(43);
+
+    auto value = test_type{};
+    EXPECT_TRUE(first.read(value));
+    EXPECT_EQ(42u, value);
+    EXPECT_TRUE(first.read(value));
+    EXPECT_EQ(43u, value);
+    EXPECT_FALSE(first.read(value));
+
+    EXPECT_TRUE(second.read(value));
+    EXPECT_EQ(43u, value);
+    EXPECT_FALSE(second.read(value));
+    EXPECT_EQ(0u, first.lost() + second.lost());
+}
+
+TEST(SeqlockRingTest, lappedReaderCountsLostMessages) {
+    SeqlockRing<test_type, 4> ring;
+    auto reader = ring.reader();
+    for (auto i = 0u; i < 10; ++i) {
+        ring.push(42 + i);
+    }
+
+    auto value = test_type{};
+    EXPECT_TRUE(reader.read(value));
+    // Messages 0..6 were overwritten; 7 is the oldest that cannot be under rewrite
+    EXPECT_EQ(49u, value);
+    EXPECT_EQ(7u, reader.lost());
+    EXPECT_TRUE(reader.read(value));
+    EXPECT_TRUE(reader.read(value));
+    EXPECT_EQ(51u, value);
+    EXPECT_FALSE(reader.read(value));
+    EXPECT_EQ(7u, ring.readerFromOldest().position());
+}
+
+TEST(SeqlockRingTest, readersNeverSeeTornMessages) {
+    struct Pair {
+        std::uint64_t value;
+        std::uint64_t check;
+    };
+    constexpr auto items = 100000u;
+    SeqlockRing<Pair, 8> ring;
+    std::atomic<bool> done{false};
+
+    // Readers exist before the first push, so every message is either read or counted as lost
+    auto consume = [&](SeqlockRing<Pair, 8>::Reader reader) {
+        Pair pair;
+        std::uint64_t count = 0;
+        std::uint64_t last = 0;
+        while (true) {
+            auto finished = done.load(std::memory_order_acquire);
+            while (reader.read(pair)) {
+                EXPECT_EQ(~pair.value, pair.check);
+                EXPECT_TRUE(count == 0 or pair.value > last);
+                last = pair.value;
+                ++count;
+            }
+            if (finished) {
+                break;
+            }
+        }
+        EXPECT_EQ(items, count + reader.lost());
+    };
+    std::thread first{consume, ring.readerFromOldest()};
+    std::thread second{consume, ring.readerFromOldest()};
+
+    Seqlock<Pair> latest;
+    for (auto i = 0u; i < items; ++i) {
+        ring.push(Pair{i, ~std::uint64_t{i}});
+        latest.store(Pair{i, ~std::uint64_t{i}});
+    }
+    done.store(true, std::memory_order_release);
+    first.join();
+    second.join();
+
+    Pair pair;
+    latest.load(pair);
+    EXPECT_EQ(items - 1, pair.value);
+    EXPECT_EQ(items, latest.version());
+}
+
+TEST(ConflatingQueueTest, keepsLatestValuePerKey) {
+    ConflatingQueue<test_type, 8> queue{4};
+    queue.push(2, 42);
+    queue.push(0, 10);
+    queue.push(2, 43);
+    queue.push(2, 44);
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(3u, queue.version(2));
+    EXPECT_EQ(2u, queue.conflated());
+
+    auto key = std::uint32_t{};
+    auto value = test_type{};
+    EXPECT_TRUE(queue.pop(key, value));
+    EXPECT_EQ(2u, key);
+    EXPECT_EQ(44u, value);
+    EXPECT_TRUE(queue.pop(key, value));
+    EXPECT_EQ(0u, key);
+    EXPECT_EQ(10u, value);
+    EXPECT_FALSE(queue.pop(key, value));
+
+    queue.push(2, 45);
+    std::vector<test_type> drained;
+    EXPECT_EQ(1u, queue.drain([&](std::uint32_t, test_type v) { drained.push_back(v); }));
+    EXPECT_EQ((std::vector<test_type>{45}), drained);
+    EXPECT_THROW((ConflatingQueue<test_type, 8>{9}), std::invalid_argument);
+    EXPECT_THROW((ConflatingQueue<test_type, 8>{~std::size_t{0}}), std::invalid_argument);
+}
+
+TEST(ConflatingQueueTest, consumerEndsWithLatestValues) {
+    constexpr auto keys = 16u;
+    constexpr auto rounds = 5000u;
+    ConflatingQueue<test_type, 16> queue{keys};
+    std::atomic<bool> done{false};
+
+    std::thread producer{[&] {
+        for (auto round = 1u; round <= rounds; ++round) {
+            for (auto key = 0u; key < keys; ++key) {
+                queue.push(key, round);
+            }
+        }
+        done.store(true, std::memory_order_release);
+    }};
+
+    std::vector<test_type> latest(keys, 0);
+    while (true) {
+        auto finished = done.load(std::memory_order_acquire);
+        queue.drain([&](std::uint32_t key, test_type value) {
+            EXPECT_LE(latest[key], value);
+            latest[key] = value;
+        });
+        if (finished and queue.empty()) {
+            break;
+        }
+    }
+    producer.join();
+    EXPECT_EQ(std::vector<test_type>(keys, rounds), latest);
+}
+
+namespace {
+
+/// Empty journal directory removed at the end of the test
+struct JournalDirectory {
+    std::filesystem::path path{std::filesystem::path{::testing::TempDir()} / "unitTests_journal"};
+
+    JournalDirectory() { std::filesystem::remove_all(path); }
+    ~JournalDirectory() { std::filesystem::remove_all(path); }
+};
+
+}  // namespace
+
+TEST(JournalTest, tailerFollowsRolledSegments) {
+    JournalDirectory directory;
+    JournalConfig config;
+    config.segmentSize = 4096;
+    Journal journal{directory.path, config};
+    JournalTailer tailer{directory.path};
+
+    auto value = std::uint64_t{};
+    EXPECT_FALSE(tailer.read(value));
+    // 16 bytes per record: several segments' worth
+    for (auto i = std::uint64_t{}; i < 1000; ++i) {
+        journal.append(i);
+    }
+    EXPECT_EQ(4u, journal.position().segment);
+
+    for (auto i = std::uint64_t{}; i < 1000; ++i) {
+        ASSERT_TRUE(tailer.read(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(tailer.read(value));
+
+    std::string text{"variable length"};
+    journal.append(text.data(), static_cast<std::uint32_t>(text.size()));
+    EXPECT_TRUE(tailer.read([&](const std::byte* data, std::uint32_t size) {
+        EXPECT_EQ(text, std::string(reinterpret_cast<const char*>(data), size));
+    }));
+    EXPECT_THROW(journal.append(nullptr, 4096), std::invalid_argument);
+}
+
+TEST(JournalTest, rejectsSegmentTooSmallForARecord) {
+    JournalDirectory directory;
+    JournalConfig config;
+    config.segmentSize = 64;
+    EXPECT_THROW(Journal(directory.path, config), std::invalid_argument);
+    EXPECT_FALSE(std::filesystem::exists(directory.path / "0000000000000000.seg"));
+}
+
+TEST(JournalTest, restartedProducerAndTailerResume) {
+    JournalDirectory directory;
+    JournalConfig config;
+    config.segmentSize = 4096;
+    config.sync = SyncPolicy::PerBatch;
+    {
+        Journal journal{directory.path, config};
+        for (auto i = std::uint64_t{}; i < 300; ++i) {
+            journal.append(i);
+        }
+        journal.endBatch();
+
+        JournalTailer tailer{directory.path, "consumer"};
+        EXPECT_EQ(300u, tailer.replay([](const std::byte*, std::uint32_t) {}));
+        tailer.checkpoint();
+    }
+
+    Journal journal{directory.path, config};
+    for (auto i = std::uint64_t{300}; i < 400; ++i) {
+        journal.append(i);
+    }
+    JournalTailer tailer{directory.path, "consumer"};
+    auto value = std::uint64_t{};
+    EXPECT_TRUE(tailer.read(value));
+    EXPECT_EQ(300u, value);
+    EXPECT_EQ(99u, tailer.replay([](const std::byte*, std::uint32_t) {}));
+
+    JournalTailer fresh{directory.path};
+    EXPECT_EQ(400u, fresh.replay([](const std::byte*, std::uint32_t) {}));
+}
+
+TEST(WorkloadTest, schedulesKeepTheMeanRate) {
+    for (auto arrival : {Arrival::Constant, Arrival::OnOff, Arrival::Poisson}) {
+        WorkloadConfig config;
+        config.arrival = arrival;
+        config.rate = 1e6;
+        config.items = 1 << 16;
+        auto schedule = arrivalSchedule(config);
+        ASSERT_EQ(std::size_t(config.items), schedule.size());
+        EXPECT_TRUE(std::is_sorted(schedule.begin(), schedule.end()));
+        // 1us per item on average
+        EXPECT_NEAR(double(config.items) * 1000.0, double(schedule.back()), double(config.items) * 50.0);
+    }
+}
+
+TEST(WorkloadTest, adapterDrivesEveryQueueInterface) {
+    WorkloadConfig config;
+    config.rate = 2e6;
+    config.items = 2000;
+    config.producerCpu = -1;
+    config.consumerCpu = -1;
+    auto schedule = arrivalSchedule(config);
+
+    auto local = makeQueue<SPSCLocal<std::int64_t, 64>>(64);
+    auto result = runWorkload(*local, config, schedule);
+    EXPECT_EQ(config.items, result.delivered);
+    EXPECT_EQ(std::size_t(config.items), result.latency.size());
+
+    auto rigtorpQueue = makeQueue<rigtorp::SPSCQueue<std::int64_t>>(64);
+    std::int64_t value = 0;
+    EXPECT_FALSE(tryPop(*rigtorpQueue, value));
+    EXPECT_TRUE(tryPush(*rigtorpQueue, std::int64_t{42}));
+    EXPECT_TRUE(tryPop(*rigtorpQueue, value));
+    EXPECT_EQ(42, value);
+    config.overload = Overload::Drop;
+    result = runWorkload(*rigtorpQueue, config, schedule);
+    EXPECT_EQ(config.items, result.delivered + result.dropped);
+}
+
+template<typename Q>
+static void expectBaselineQueue(Q& queue, std::size_t capacity) {
+    EXPECT_TRUE(queueEmpty(queue));
+    EXPECT_EQ(capacity, queueCapacity(queue));
+    std::int64_t value = 0;
+    EXPECT_FALSE(tryPop(queue, value));
+    for (auto i = std::int64_t{}; i < std::int64_t(capacity); ++i) {
+        EXPECT_TRUE(tryPush(queue, i));
+    }
+    EXPECT_FALSE(tryPush(queue, std::int64_t{42}));
+    EXPECT_FALSE(queueEmpty(queue));
+    for (auto i = std::int64_t{}; i < std::int64_t(capacity); ++i) {
+        EXPECT_TRUE(tryPop(queue, value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_TRUE(queueEmpty(queue));
+}
+
+TEST(WorkloadTest, adapterDrivesThirdPartyBaselines) {
+    auto boostQueue = makeQueue<boost::lockfree::spsc_queue<std::int64_t, boost::lockfree::capacity<16>>>(16);
+    expectBaselineQueue(*boostQueue, 16);
+    boost::lockfree::spsc_queue<std::int64_t> boostRuntime{16};
+    expectBaselineQueue(boostRuntime, 16);
+    auto follyQueue = makeQueue<folly::ProducerConsumerQueue<std::int64_t>>(17);
+    expectBaselineQueue(*follyQueue, 16);
+    auto mutexQueue = makeQueue<MutexQueue<std::int64_t>>(16);
+    expectBaselineQueue(*mutexQueue, 16);
+
+    std::thread producer{[&] {
+        for (auto i = std::int64_t{}; i < 1000; ++i) {
+            mutexQueue->pushWait(i);
+        }
+    }};
+    std::int64_t value;
+    for (auto i = std::int64_t{}; i < 1000; ++i) {
+        mutexQueue->popWait(value);
+        EXPECT_EQ(i, value);
+    }
+    producer.join();
+}
+
+TEST(BulkTest, pushBulkAndPopBulkSplitAtTheWrap) {
+    SPSCLocal<test_type, 8> fifo;
+    test_type in[12];
+    test_type out[11] = {};
+    for (auto i = 0u; i < 12; ++i) {
+        in[i] = 42 + i;
+    }
+
+    EXPECT_EQ(5u, fifo.pushBulk(in, 5));
+    EXPECT_EQ(3u, fifo.popBulk(out, 3));
+    // 2 queued and 6 free: only 6 of 7 fit, and the batch wraps after 3
+    EXPECT_EQ(6u, fifo.pushBulk(in + 5, 7));
+    EXPECT_TRUE(fifo.full());
+    EXPECT_EQ(0u, fifo.pushBulk(in, 1));
+
+    EXPECT_EQ(8u, fifo.popBulk(out + 3, 10));
+    for (auto i = 0u; i < 11; ++i) {
+        EXPECT_EQ(42u + i, out[i]);
+    }
+    EXPECT_EQ(0u, fifo.popBulk(out, 1));
+    EXPECT_TRUE(fifo.empty());
+}
+
+namespace {
+
+template<typename Copy>
+void expectCopiesEveryAlignmentAndLength(Copy copy) {
+    std::vector<std::byte> src(1000), dst(1000);
+    for (auto i = 0u; i < src.size(); ++i) {
+        src[i] = static_cast<std::byte>(i * 7);
+    }
+    for (auto offset : {0u, 1u, 13u, 32u}) {
+        for (auto length : {0u, 1u, 31u, 64u, 255u, 900u}) {
+            for (auto streaming : {false, true}) {
+                std::fill(dst.begin(), dst.end(), std::byte{});
+                copy(dst.data() + offset, src.data(), length, streaming);
+                EXPECT_TRUE(std::equal(src.begin(), src.begin() + length, dst.begin() + offset));
+                EXPECT_EQ(std::byte{}, dst[offset + length]);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+TEST(BulkTest, kernelsCopyEveryAlignmentAndLength) {
+    expectCopiesEveryAlignmentAndLength([](std::byte* dst, const std::byte* src, std::size_t length, bool streaming) {
+        bulkCopyBytes(dst, src, length, streaming);
+    });
+}
+
+#if defined(BULK_COPY_X86)
+// The tests are not built with -march=native, so run the vector kernels directly
+TEST(BulkTest, avx2KernelsCopyEveryAlignmentAndLength) {
+    if (not __builtin_cpu_supports("avx2")) {
+        GTEST_SKIP() << "CPU without AVX2";
+    }
+    expectCopiesEveryAlignmentAndLength([](std::byte* dst, const std::byte* src, std::size_t length, bool streaming) {
+        streaming ? bulk_detail::avx2::streamVectors(dst, src, length) : bulk_detail::avx2::copyVectors(dst, src, length);
+    });
+}
+
+TEST(BulkTest, avx512KernelsCopyEveryAlignmentAndLength) {
+    if (not __builtin_cpu_supports("avx512f")) {
+        GTEST_SKIP() << "CPU without AVX-512F";
+    }
+    expectCopiesEveryAlignmentAndLength([](std::byte* dst, const std::byte* src, std::size_t length, bool streaming) {
+        streaming ? bulk_detail::avx512::streamVectors(dst, src, length) : bulk_detail::avx512::copyVectors(dst, src, length);
+    });
+}
+#endif
+
+TEST(SPSCCompactTest, oneLinePerSideAndCoAllocatedRing) {
+    using Fifo = SPSCCompact<test_type, 4>;
+    static_assert(sizeof(Fifo) == 2 * CACHE_LINE_SIZE);
+    static_assert(std::is_same_v<Fifo::size_type, std::uint32_t>);
+    EXPECT_EQ(2 * CACHE_LINE_SIZE + 4 * sizeof(test_type), Fifo::allocationSize());
+
+    auto fifo = Fifo::create();
+    EXPECT_EQ(4u, fifo->capacity());
+    EXPECT_TRUE(fifo->empty());
+    auto value = test_type{};
+    for (auto i = 0u; i < fifo->capacity() * 4; ++i) {
+        EXPECT_TRUE(fifo->push(42 + i));
+        EXPECT_TRUE(fifo->push(43 + i));
+        EXPECT_EQ(2u, fifo->size());
+        EXPECT_TRUE(fifo->pop(value));
+        EXPECT_EQ(42u + i, value);
+        EXPECT_TRUE(fifo->pop(value));
+        EXPECT_FALSE(fifo->pop(value));
+    }
+    for (auto i = 0u; i < fifo->capacity(); ++i) {
+        EXPECT_TRUE(fifo->push(i));
+    }
+    EXPECT_TRUE(fifo->full());
+    EXPECT_FALSE(fifo->push(42));
+
+    alignas(CACHE_LINE_SIZE) std::byte arena[Fifo::allocationSize()];
+    auto* placed = Fifo::construct(arena);
+    EXPECT_TRUE(placed->push(42));
+    // The ring starts right after the two header lines
+    test_type stored;
+    std::memcpy(&stored, arena + sizeof(Fifo), sizeof(stored));
+    EXPECT_EQ(42u, stored);
+    placed->~Fifo();
+}
+
+TEST(SPSCCompactTest, crossThreadTransfer) {
+    constexpr auto items = 100000u;
+    auto fifo = SPSCCompact<test_type, 16>::create();
+    std::thread producer{[&] {
+        for (auto i = 0u; i < items; ++i) {
+            while (not fifo->push(i)) {
+                ;
+            }
+        }
+    }};
+    auto value = test_type{};
+    for (auto i = 0u; i < items; ++i) {
+        while (not fifo->pop(value)) {
+            ;
+        }
+        ASSERT_EQ(i, value);
+    }
+    producer.join();
+}
+
+TEST(SPSCInlineTest, ringFollowsTheCursorLinesInStaticStackOrPlacedStorage) {
+    using Fifo = SPSCInline<test_type, 64>;
+    static_assert(sizeof(Fifo) == 4 * CACHE_LINE_SIZE + 64 * sizeof(test_type));
+    static_assert(alignof(Fifo) == CACHE_LINE_SIZE);
+
+    constinit static Fifo statik;
+    Fifo onStack;
+    alignas(Fifo) std::byte arena[sizeof(Fifo)];
+    auto* placed = new (arena) Fifo;
+
+    auto value = test_type{};
+    for (auto* fifo : {&statik, &onStack, placed}) {
+        for (auto i = 0u; i < 3 * 64; ++i) {
+            EXPECT_TRUE(fifo->push(i));
+            EXPECT_TRUE(fifo->pop(value));
+            EXPECT_EQ(i, value);
+        }
+        EXPECT_TRUE(fifo->push(42));
+    }
+    // Slot 3 * 64 % 64 == 0 sits right after the four cursor lines
+    test_type stored;
+    std::memcpy(&stored, arena + 4 * CACHE_LINE_SIZE, sizeof(stored));
+    EXPECT_EQ(42u, stored);
+    placed->~Fifo();
+}
+
+TEST(LatencySamplesTest, mergedSamplesShareOnePercentileRanking) {
+    LatencySamples a;
+    LatencySamples b;
+    for (auto ns = 1; ns <= 50; ++ns) {
+        a.record(ns);
+        b.record(100 + ns);
+    }
+    EXPECT_EQ(50, a.percentile(100));
+
+    a.merge(b);
+    EXPECT_EQ(100u, a.size());
+    EXPECT_EQ(1, a.percentile(0));
+    EXPECT_EQ(150, a.max());
+    EXPECT_EQ(101, a.percentile(51));
+}
+
+TEST(RunStatsTest, summaryAndWelchTest) {
+    auto stats = summarize({5, 1, 3, 2, 4});
+    EXPECT_EQ(5u, stats.count);
+    EXPECT_DOUBLE_EQ(3, stats.mean);
+    EXPECT_DOUBLE_EQ(3, stats.median);
+    EXPECT_DOUBLE_EQ(1, stats.min);
+    EXPECT_DOUBLE_EQ(5, stats.max);
+    EXPECT_NEAR(1.5811, stats.stddev, 1e-4);
+    // t(4) = 2.776
+    EXPECT_NEAR(3 - 2.776 * 1.5811 / std::sqrt(5.0), stats.ciLow, 1e-3);
+
+    auto same = welchTest(stats, summarize({1.5, 2.5, 3.5, 4.5, 3}));
+    EXPECT_FALSE(same.significant);
+    auto slower = welchTest(summarize({90, 91, 89, 90, 90}), summarize({100, 101, 99, 100, 100}));
+    EXPECT_TRUE(slower.significant);
+    EXPECT_LT(slower.t, 0);
+}
+
+TEST(IndexPolicyTest, policiesAgreeWithModulo) {
+    static_assert(power_of_two<64> and not power_of_two<100>);
+    ModuloIndex<100'000> modulo;
+    FastModIndex<100'000> fastMod;
+    FastModIndex<7> fastModSmall;
+    WrapIndex<100'000> wrap;
+    for (std::size_t cursor : {std::size_t{0}, std::size_t{99'999}, std::size_t{100'000}, std::size_t{1} << 40,
+                               ~std::size_t{} - 5, ~std::size_t{}}) {
+        EXPECT_EQ(modulo(cursor), fastMod(cursor)) << cursor;
+        EXPECT_EQ(cursor % 7, fastModSmall(cursor)) << cursor;
+        EXPECT_EQ(modulo(cursor), wrap(cursor)) << cursor;
+    }
+    // Sequential cursors take the compare and reset path across the wrap
+    for (std::size_t cursor = 199'990; cursor < 200'010; ++cursor) {
+        EXPECT_EQ(modulo(cursor), wrap(cursor)) << cursor;
+        EXPECT_EQ(modulo(cursor), fastMod(cursor)) << cursor;
+    }
+}
+
+TEST(IndexPolicyTest, nonPowerOfTwoCapacityQueue) {
+    SPSCLocal<test_type, 5, std::allocator<test_type>, FastModIndex<5>> fifo;
+    SPSCLocal<test_type, 5, std::allocator<test_type>, WrapIndex<5>> wrapped;
+    EXPECT_EQ(5u, fifo.capacity());
+    test_type value;
+    test_type next = 0;
+    for (auto round = 0; round < 7; ++round) {
+        for (auto i = 0; i < 5; ++i) {
+            EXPECT_TRUE(fifo.push(next + i));
+            EXPECT_TRUE(wrapped.push(next + i));
+        }
+        EXPECT_FALSE(fifo.push(0));
+        EXPECT_FALSE(wrapped.push(0));
+        for (auto i = 0; i < 5; ++i) {
+            EXPECT_TRUE(fifo.pop(value));
+            EXPECT_EQ(next + i, value);
+            EXPECT_TRUE(wrapped.pop(value));
+            EXPECT_EQ(next + i, value);
+        }
+        next += 5;
+        // Shift the cursors so the next round starts mid-ring
+        fifo.push(next);
+        fifo.pop(value);
+        wrapped.push(next);
+        wrapped.pop(value);
+        ++next;
+    }
+
+    // Bulk copies split where a non-power-of-two ring wraps
+    test_type in[4] = {1, 2, 3, 4};
+    test_type out[4] = {};
+    EXPECT_EQ(4u, fifo.pushBulk(in, 4));
+    EXPECT_EQ(4u, fifo.popBulk(out, 4));
+    EXPECT_TRUE(std::equal(in, in + 4, out));
+}
+
+TEST(CacheLineTest, layoutSeparatesOrGroupsCursors) {
+    using Packed = SPSCLocal<test_type, 8, std::allocator<test_type>, MaskIndex<8>, CursorLayout<0>>;
+    using Wide = SPSCLocal<test_type, 8, std::allocator<test_type>, MaskIndex<8>, CursorLayout<256>>;
+    using Grouped = SPSCLocal<test_type, 8, std::allocator<test_type>, MaskIndex<8>,
+                              CursorLayout<128, CursorGrouping::ByWriter>>;
+    static_assert(sizeof(SPSCLocal<test_type, 8>) == 5 * cacheLineSize);
+    static_assert(sizeof(Packed) < 64);
+    static_assert(sizeof(Wide) == 5 * 256);
+    static_assert(sizeof(Grouped) == 3 * 128);
+
+    Packed packed;
+    Grouped grouped;
+    test_type value;
+    for (auto i = 0u; i < 20; ++i) {
+        EXPECT_TRUE(packed.push(i));
+        EXPECT_TRUE(grouped.push(i));
+        EXPECT_TRUE(packed.pop(value));
+        EXPECT_EQ(i, value);
+        EXPECT_TRUE(grouped.pop(value));
+        EXPECT_EQ(i, value);
+    }
+}
+
+#ifdef __linux__
+
+static bool readable(int fd) {
+    pollfd pfd{fd, POLLIN, 0};
+    return ::poll(&pfd, 1, 0) == 1;
+}
+
+TEST(NotifyingSPSCTest, signalsOnlyWhenConsumerSleeps) {
+    NotifyingSPSC<test_type, 4> fifo;
+    EXPECT_TRUE(fifo.push(42));
+    EXPECT_TRUE(fifo.push(43));
+    EXPECT_EQ(0u, fifo.signals());
+    EXPECT_FALSE(readable(fifo.fd()));
+
+    // Elements pending: the consumer must keep draining instead of sleeping
+    EXPECT_FALSE(fifo.prepareToSleep());
+
+    auto value = test_type{};
+    EXPECT_TRUE(fifo.pop(value));
+    EXPECT_TRUE(fifo.pop(value));
+    EXPECT_FALSE(fifo.pop(value));
+    EXPECT_TRUE(fifo.prepareToSleep());
+    EXPECT_FALSE(readable(fifo.fd()));
+
+    EXPECT_TRUE(fifo.push(44));
+    EXPECT_EQ(1u, fifo.signals());
+    EXPECT_TRUE(readable(fifo.fd()));
+
+    EXPECT_TRUE(fifo.push(45));
+    EXPECT_EQ(1u, fifo.signals());
+
+    fifo.acknowledge();
+    EXPECT_FALSE(readable(fifo.fd()));
+    EXPECT_TRUE(fifo.pop(value));
+    EXPECT_EQ(44u, value);
+}
+
+
+TEST(MirroredRingTest, secondMappingAliasesTheFirst) {
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    MirroredAllocator<std::uint32_t> allocator;
+    const auto n = page / sizeof(std::uint32_t);
+    auto* ring = allocator.allocate(n);
+    ring[3] = 42;
+    EXPECT_EQ(42u, ring[n + 3]);
+    ring[2 * n - 1] = 7;
+    EXPECT_EQ(7u, ring[n - 1]);
+    allocator.deallocate(ring, n);
+
+    EXPECT_THROW(allocator.allocate(n + 1), std::invalid_argument);
+}
+
+TEST(MirroredRingTest, spansDoNotSplitAtTheWrap) {
+    SPSCLocal<std::byte, 4096, MirroredAllocator<std::byte>> mirrored;
+    SPSCLocal<std::byte, 4096> plain;
+    std::vector<std::byte> data(4000);
+    for (auto i = std::size_t{}; i < data.size(); ++i) {
+        data[i] = std::byte(i % 251);
+    }
+    // Move both cursors close to the end of the ring
+    plain.commit(plain.prepare(4000).size());
+    plain.consume(plain.peek().size());
+    mirrored.commit(mirrored.prepare(4000).size());
+    mirrored.consume(mirrored.peek().size());
+
+    EXPECT_EQ(96u, plain.prepare(data.size()).size());
+    auto window = mirrored.prepare(data.size());
+    ASSERT_EQ(data.size(), window.size());
+    std::memcpy(window.data(), data.data(), data.size());
+    mirrored.commit(data.size());
+    EXPECT_EQ(96u, mirrored.prepare().size());
+
+    auto readable = mirrored.peek();
+    ASSERT_EQ(data.size(), readable.size());
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), readable.begin()));
+    mirrored.consume(readable.size());
+    EXPECT_TRUE(mirrored.empty());
+
+    // Bulk copies go through the mirror in one piece
+    EXPECT_EQ(data.size(), mirrored.pushBulk(data.data(), data.size()));
+    std::vector<std::byte> out(data.size());
+    EXPECT_EQ(data.size(), mirrored.popBulk(out.data(), out.size()));
+    EXPECT_EQ(data, out);
+}
+
+
+static std::vector<std::string> readLines(const std::filesystem::path& path) {
+    std::ifstream in{path};
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+TEST(AsyncLoggerTest, formatsRecordsFromEveryThreadOnTheBackend) {
+    auto path = std::filesystem::temp_directory_path() / "async_logger_test.log";
+    std::filesystem::remove(path);
+    enum class Side : std::int8_t { Buy = 1, Sell = 2 };
+    static constexpr LogSite<int, double, Side, bool> order{"order {} at {} side {} {{ok={}}}"};
+    {
+        AsyncLogger<4096> logger{path, LogOverflow::Block};
+        std::thread other{[&] {
+            for (auto i = 0; i < 500; ++i) {
+                ASYNC_LOG(logger, "other {}", i);
+            }
+        }};
+        for (auto i = 0; i < 500; ++i) {
+            EXPECT_TRUE(logger.log(order, i, 1.5, Side::Sell, true));
+        }
+        other.join();
+        logger.flush();
+        EXPECT_EQ(1000u, logger.written());
+        EXPECT_EQ(0u, logger.dropped());
+        ASYNC_LOG(logger, "no arguments");
+    }
+
+    auto lines = readLines(path);
+    ASSERT_EQ(1001u, lines.size());
+    auto orders = std::count_if(lines.begin(), lines.end(), [](const std::string& line) {
+        return line.find("] order ") != std::string::npos;
+    });
+    EXPECT_EQ(500, orders);
+    EXPECT_EQ(1, std::count_if(lines.begin(), lines.end(), [](const std::string& line) {
+        return line.ends_with("] order 499 at 1.5 side 2 {ok=true}");
+    }));
+    EXPECT_EQ(1, std::count_if(lines.begin(), lines.end(), [](const std::string& line) {
+        return line.ends_with("] other 499");
+    }));
+    EXPECT_TRUE(lines.back().ends_with("] no arguments"));
+    // [seconds.nanoseconds] prefix
+    EXPECT_EQ('[', lines.front()[0]);
+    EXPECT_EQ(9u, lines.front().find(']') - lines.front().find('.') - 1);
+    std::filesystem::remove(path);
+}
+
+TEST(AsyncLoggerTest, dropPolicyCountsWhatDidNotFit) {
+    auto path = std::filesystem::temp_directory_path() / "async_logger_drop.log";
+    std::filesystem::remove(path);
+    std::uint64_t logged = 0;
+    std::uint64_t dropped = 0;
+    {
+        AsyncLogger<4096> logger{path, LogOverflow::Drop, std::chrono::microseconds{2000}};
+        for (auto i = 0; i < 5000; ++i) {
+            logged += ASYNC_LOG(logger, "tick {}", std::int64_t{i});
+        }
+        dropped = logger.dropped();
+    }
+    EXPECT_GT(dropped, 0u);
+    EXPECT_EQ(5000u, logged + dropped);
+    EXPECT_EQ(logged, readLines(path).size());
+    std::filesystem::remove(path);
+}
+
+
+TEST(ReclaimTest, releasesColdPagesAndKeepsUnconsumedOnes) {
+    using Fifo = SPSCLocal<std::int64_t, 1 << 16, ReservedAllocator<std::int64_t>>;
+    const auto page = ReservedAllocator<std::int64_t>::pageSize();
+    auto fifo = std::make_unique<Fifo>();
+    const auto capacity = static_cast<std::int64_t>(fifo->capacity());
+    EXPECT_EQ(0u, fifo->residentBytes());
+
+    for (auto i = std::int64_t{}; i < capacity; ++i) {
+        ASSERT_TRUE(fifo->push(i));
+    }
+    EXPECT_EQ(fifo->capacity() * sizeof(std::int64_t), fifo->residentBytes());
+
+    std::int64_t value;
+    for (auto i = std::int64_t{}; i < capacity - 10; ++i) {
+        ASSERT_TRUE(fifo->pop(value));
+    }
+    // Everything but the last page, which still holds ten elements
+    EXPECT_EQ(fifo->capacity() * sizeof(std::int64_t) - page, fifo->reclaim());
+    EXPECT_EQ(page, fifo->residentBytes());
+
+    for (auto i = capacity; i < capacity + 1000; ++i) {
+        ASSERT_TRUE(fifo->push(i));
+    }
+    for (auto i = capacity - 10; i < capacity + 1000; ++i) {
+        ASSERT_TRUE(fifo->pop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_TRUE(fifo->empty());
+}
+
+TEST(ReclaimTest, idleReclaimerWaitsForTheIntervalBelowTheWatermark) {
+    using Fifo = SPSCLocal<std::int64_t, 1 << 14, ReservedAllocator<std::int64_t>>;
+    using namespace std::chrono_literals;
+    auto fifo = std::make_unique<Fifo>();
+    IdleReclaimer reclaimer{*fifo, 16, 10ms};
+    auto now = std::chrono::steady_clock::time_point{};
+
+    for (auto i = std::int64_t{}; i < 1000; ++i) {
+        ASSERT_TRUE(fifo->push(i));
+    }
+    EXPECT_EQ(0u, reclaimer.poll(now));
+    EXPECT_EQ(0u, reclaimer.poll(now + 1s));
+
+    std::int64_t value;
+    while (fifo->pop(value)) {
+    }
+    EXPECT_EQ(0u, reclaimer.poll(now));
+    EXPECT_EQ(0u, reclaimer.poll(now + 5ms));
+    EXPECT_GT(reclaimer.poll(now + 10ms), 0u);
+    EXPECT_EQ(0u, reclaimer.poll(now + 15ms));
+    EXPECT_EQ(1u, reclaimer.reclaims());
+}
+
+TEST(ReclaimTest, rejectsElementsLargerThanAPage) {
+    // Larger than any page size in use, and a power of two so only the page check applies
+    using Element = std::array<std::byte, std::size_t{1} << 20>;
+    ReservedAllocator<Element> alloc;
+    EXPECT_THROW(alloc.allocate(4), std::invalid_argument);
+}
+
+TEST(ReclaimTest, producerNeverWritesIntoReleasedPages) {
+    using Fifo = SPSCLocal<std::int64_t, 1 << 12, ReservedAllocator<std::int64_t>>;
+    auto fifo = std::make_unique<Fifo>();
+    constexpr std::int64_t items = 200'000;
+
+    std::thread producer{[&] {
+        for (auto i = std::int64_t{}; i < items;) {
+            if (i % 3 == 0) {
+                std::int64_t batch[64];
+                std::iota(batch, batch + 64, i);
+                i += static_cast<std::int64_t>(fifo->pushBulk(batch, std::min<std::int64_t>(64, items - i)));
+            } else {
+                i += fifo->push(i);
+            }
+        }
+    }};
+    std::int64_t value;
+    for (auto i = std::int64_t{}; i < items;) {
+        if (fifo->pop(value)) {
+            EXPECT_EQ(i, value);
+            ++i;
+        } else {
+            fifo->reclaim();
+        }
+    }
+    producer.join();
+}
+
+/// Pushes `total` bytes of a 251-periodic pattern through `ring` in uneven chunks
+template<typename Ring>
+static void produceSinkPattern(Ring& ring, std::size_t total) {
+    for (std::size_t i = 0; i < total;) {
+        auto span = ring.prepare(std::min<std::size_t>(total - i, 1 + i % 700));
+        for (auto& b : span) {
+            b = static_cast<std::byte>(i++ % 251);
+        }
+        ring.commit(span.size());
+    }
+}
+
+TEST(BatchSinkTest, fileReceivesEveryByteInOrderWithBothBackends) {
+    constexpr std::size_t total = 300'000;
+    for (auto backend : {SinkBackend::Writev, SinkBackend::Uring}) {
+        auto path = std::filesystem::temp_directory_path() / "unitTests_batch_sink.bin";
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        ASSERT_NE(-1, fd);
+        auto ring = std::make_unique<SPSCLocal<std::byte, 4096>>();
+        {
+            BatchSink sink{*ring, fd, backend, 1000, 4};
+            std::thread producer{[&] { produceSinkPattern(*ring, total); }};
+            while (sink.written() < total) {
+                sink.poll();
+            }
+            producer.join();
+            sink.flush();
+            EXPECT_LT(sink.syscalls(), total / 100);
+        }
+        EXPECT_EQ(off_t(total), ::lseek(fd, 0, SEEK_CUR));
+        ::close(fd);
+
+        std::ifstream in{path, std::ios::binary};
+        std::vector<char> bytes{std::istreambuf_iterator<char>{in}, {}};
+        ASSERT_EQ(total, bytes.size());
+        for (std::size_t i = 0; i < total; ++i) {
+            ASSERT_EQ(char(i % 251), bytes[i]) << "at byte " << i;
+        }
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(BatchSinkTest, slowSocketFillsTheRingAndKeepsOrder) {
+    constexpr std::size_t total = 200'000;
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds));
+    int small = 4096;
+    ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+
+    auto ring = std::make_unique<SPSCLocal<std::byte, 4096>>();
+    std::atomic<bool> sawFull{false};
+    std::vector<std::byte> received;
+    std::thread reader{[&] {
+        std::byte buffer[512];
+        while (received.size() < total) {
+            auto n = ::read(fds[1], buffer, sizeof(buffer));
+            ASSERT_GT(n, 0);
+            received.insert(received.end(), buffer, buffer + n);
+            std::this_thread::sleep_for(std::chrono::microseconds{50});
+        }
+    }};
+    std::thread producer{[&] {
+        for (std::size_t i = 0; i < total;) {
+            auto span = ring->prepare(std::min<std::size_t>(total - i, 64));
+            if (span.empty()) {
+                sawFull.store(true, std::memory_order_relaxed);
+                continue;
+            }
+            for (auto& b : span) {
+                b = static_cast<std::byte>(i++ % 251);
+            }
+            ring->commit(span.size());
+        }
+    }};
+    {
+        BatchSink sink{*ring, fds[0]};
+        while (sink.written() < total) {
+            sink.poll();
+        }
+    }
+    producer.join();
+    reader.join();
+    EXPECT_TRUE(sawFull.load());
+    ASSERT_EQ(total, received.size());
+    for (std::size_t i = 0; i < total; ++i) {
+        ASSERT_EQ(static_cast<std::byte>(i % 251), received[i]) << "at byte " << i;
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(BatchSinkTest, failedWritesThrowAndDestructionWaitsForTheRest) {
+    auto path = std::filesystem::temp_directory_path() / "unitTests_batch_sink_readonly.bin";
+    std::ofstream{path} << "x";
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    ASSERT_NE(-1, fd);
+    auto ring = std::make_unique<SPSCLocal<std::byte, 4096>>();
+    produceSinkPattern(*ring, 4000);
+    {
+        BatchSink sink{*ring, fd, SinkBackend::Uring, 500, 4};
+        EXPECT_THROW({
+            for (auto i = 0; i < 1000; ++i) {
+                sink.poll();
+            }
+        }, std::system_error);
+        EXPECT_EQ(0u, sink.written());
+    }
+    ::close(fd);
+    std::filesystem::remove(path);
+}
+
+TEST(PipelineTest, startThrowsWhenPinningIsRefused) {
+    PipelineConfig config;
+    config.cpus = {-1, CPU_SETSIZE};
+    auto pipeline = makePipeline<int>(config,
+        [](int value) { return value + 1; },
+        [](int) {});
+    EXPECT_THROW(pipeline.start(), std::system_error);
+    EXPECT_EQ(0, pinThread(-1));
+    EXPECT_EQ(EINVAL, pinThread(CPU_SETSIZE));
+}
+
+#endif